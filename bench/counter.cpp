@@ -0,0 +1,65 @@
+// scaling benchmark for per-CPU counters, hosted linux
+// each pinned thread increments a statistics counter, compares one shared
+// atomic against sharded_counter_t, reports increments per second for
+// 1..N threads
+
+#include "host.h"
+
+#include <bsl/cpu.h>
+#include <bsl/percpu.h>
+
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+constexpr uint64_t ops_per_thread = 1000000;
+constexpr size_t max_cpu = 256;
+
+struct sched_cpu_t {
+  size_t operator()() const noexcept { return (size_t)sched_getcpu(); }
+};
+
+template <typename Fn>
+void run(const char *name, unsigned threads, Fn &&inc) {
+  auto ns = bsl_bench::launch(threads, [&](unsigned) {
+    for (uint64_t i = 0; i < ops_per_thread; ++i) {
+      inc();
+    }
+  });
+  auto ops = (double)(ops_per_thread * threads);
+  std::printf("%-8s threads=%-3u %12.0f inc/s %8.2f ns/inc\n", name, threads,
+              ops / ns * 1e9, ns / ops);
+}
+
+}  // namespace
+
+// usage: counter [max_threads]
+int main(int argc, char **argv) {
+  unsigned max_threads = argc > 1 ? (unsigned)std::atoi(argv[1])
+                                  : std::thread::hardware_concurrency();
+  for (unsigned n = 1;; n = std::min(n * 2, max_threads)) {
+    alignas(CACHELINE_SZ) std::atomic<uint64_t> shared{0};
+    run("shared", n,
+        [&] { shared.fetch_add(1, std::memory_order_relaxed); });
+
+    static bsl::sharded_counter_t<max_cpu, sched_cpu_t> sharded;
+    sharded.exchange();
+    run("sharded", n, [&] { sharded.add(); });
+
+    if (shared.load() != ops_per_thread * n ||
+        sharded.read() != ops_per_thread * n) {
+      std::printf("lost increments\n");
+      return 1;
+    }
+    if (n == max_threads) {
+      break;
+    }
+  }
+  return 0;
+}
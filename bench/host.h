@@ -0,0 +1,78 @@
+#pragma once
+
+// hosted linux helpers shared by the threaded benchmarks and the suite
+// driver, thread pinning, TSC calibration and a start-together launcher
+
+#include <bsl/cpu.h>
+#include <config.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace bsl_bench {
+
+// pin the calling thread, wraps around the online CPUs
+inline void pin(unsigned cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu % std::thread::hardware_concurrency(), &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// rdcycle ticks per second, measured against the monotonic clock when the
+// CPU does not report it
+inline uint64_t calibrate_hz() {
+  auto hz = bsl::rdcycle_freq();
+  if (hz != 0) {
+    return hz;
+  }
+  auto st = std::chrono::steady_clock::now();
+  auto cyc = bsl::rdcycle();
+  while (std::chrono::steady_clock::now() - st < std::chrono::milliseconds(50))
+    ;
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - st)
+                .count();
+  return (uint64_t)((uint128_t)(bsl::rdcycle() - cyc) * 1000000000U /
+                    (uint64_t)ns);
+}
+
+/**
+ * @brief run body(t) on threads pinned to CPU t, released together once
+ * all of them are up
+ * @return wall time from the release to the last join in ns
+ */
+template <typename Fn>
+double launch(unsigned threads, Fn &&body) {
+  std::atomic<unsigned> ready{0};
+  std::atomic<bool> go{false};
+  std::vector<std::thread> pool;
+  for (unsigned t = 0; t < threads; ++t) {
+    pool.emplace_back([&, t] {
+      pin(t);
+      ready.fetch_add(1);
+      while (!go.load(std::memory_order_acquire)) {
+        bsl::cpu_relax();
+      }
+      body(t);
+    });
+  }
+  while (ready.load() != threads) {
+    bsl::cpu_relax();
+  }
+  auto st = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto &th : pool) {
+    th.join();
+  }
+  return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - st)
+      .count();
+}
+
+}  // namespace bsl_bench
@@ -0,0 +1,29 @@
+// hosted driver for the bsl microbenchmark suites
+// prints through a stdout char_dev_t, --csv selects the machine readable
+// format, the TSC frequency is calibrated against the monotonic clock
+
+#include "host.h"
+#include "suites.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+struct stdout_dev_t : bsl::char_dev_t<stdout_dev_t> {
+  void send(char ch) { std::putchar(ch); }
+  char recv() { return (char)std::getchar(); }
+};
+
+}  // namespace
+
+// usage: bench [--csv]
+int main(int argc, char **argv) {
+  auto fmt = argc > 1 && std::strcmp(argv[1], "--csv") == 0 ? bsl::BENCH_CSV
+                                                            : bsl::BENCH_TEXT;
+  stdout_dev_t dev;
+  bsl::bench_t<stdout_dev_t> bench(dev, bsl_bench::calibrate_hz(), 1000,
+                                   fmt);
+  bsl_bench::run_all(bench);
+  return 0;
+}
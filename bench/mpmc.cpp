@@ -0,0 +1,222 @@
+// contention benchmark and stress test for ring_buf_t and ll_t, hosted linux
+// sweeps producer / consumer counts and batch sizes over pinned threads,
+// every element carries its producer, sequence number and send time, the
+// consumers check nothing is lost or duplicated and that each producer's
+// elements arrive in order (ring_buf_t is FIFO), reports ops/s and end to
+// end latency percentiles, exits non-zero on any violation
+
+#include "host.h"
+
+#include <bsl/cpu.h>
+#include <bsl/ll.h>
+#include <bsl/ring_buf.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct item_t {
+  uint32_t producer;
+  uint32_t seq;
+  uint64_t stamp;
+};
+
+uint64_t per_producer = 20000;
+uint64_t cycle_hz = 0;
+// set from any thread on a violation
+std::atomic<bool> failed{false};
+
+double ticks_to_ns(uint64_t ticks) {
+  return cycle_hz != 0 ? (double)ticks * 1e9 / (double)cycle_hz : 0;
+}
+
+// one delivery count per (producer, seq), detects loss and duplication
+class ledger_t {
+  std::unique_ptr<std::atomic<uint8_t>[]> seen;
+  uint64_t producers;
+
+ public:
+  explicit ledger_t(uint64_t producers)
+      : seen(new std::atomic<uint8_t>[producers * per_producer]()),
+        producers(producers) {}
+
+  void deliver(const item_t &item) {
+    if (item.producer >= producers || item.seq >= per_producer) {
+      std::printf("  corrupt element %u:%u\n", item.producer, item.seq);
+      failed = true;
+      return;
+    }
+    if (seen[item.producer * per_producer + item.seq].fetch_add(1) != 0) {
+      std::printf("  duplicate %u:%u\n", item.producer, item.seq);
+      failed = true;
+    }
+  }
+
+  void check() {
+    for (uint64_t i = 0; i < producers * per_producer; ++i) {
+      if (seen[i].load() == 0) {
+        std::printf("  lost %lu:%lu\n", (unsigned long)(i / per_producer),
+                    (unsigned long)(i % per_producer));
+        failed = true;
+        return;
+      }
+    }
+  }
+};
+
+void report(const char *name, unsigned prod, unsigned cons, uint64_t batch,
+            double ns, std::vector<uint64_t> &lat) {
+  auto ops = (double)(prod * per_producer);
+  std::printf("%-10s prod=%-2u cons=%-2u batch=%-3lu %11.0f ops/s", name, prod,
+              cons, (unsigned long)batch, ops / ns * 1e9);
+  if (!lat.empty()) {
+    std::sort(lat.begin(), lat.end());
+    auto pct = [&](double q) {
+      return ticks_to_ns(lat[(size_t)((double)(lat.size() - 1) * q)]);
+    };
+    std::printf("  lat ns p50 %8.0f p99 %8.0f p99.9 %9.0f", pct(0.5),
+                pct(0.99), pct(0.999));
+  }
+  std::printf("\n");
+}
+
+template <uint64_t Sz>
+void ring_case(unsigned prod, unsigned cons, uint64_t batch) {
+  auto ring = std::make_unique<bsl::ring_buf_t<item_t, Sz>>();
+  ledger_t ledger(prod);
+  std::atomic<uint64_t> consumed{0};
+  std::vector<std::vector<uint64_t>> lat(cons);
+  auto total = prod * per_producer;
+
+  auto ns = bsl_bench::launch(prod + cons, [&](unsigned t) {
+    std::vector<item_t> buf(batch);
+    if (t < prod) {
+      for (uint64_t seq = 0; seq < per_producer;) {
+        auto n = std::min(batch, per_producer - seq);
+        auto now = bsl::rdcycle();
+        for (uint64_t i = 0; i < n; ++i) {
+          buf[i] = {t, (uint32_t)(seq + i), now};
+        }
+        for (uint64_t done = 0; done < n;) {
+          auto wrote = ring->nb_write(buf.data() + done, n - done);
+          if (wrote == 0) {
+            bsl::cpu_relax();
+          }
+          done += wrote;
+        }
+        seq += n;
+      }
+      return;
+    }
+    auto &my_lat = lat[t - prod];
+    std::vector<int64_t> last(prod, -1);
+    while (consumed.load(std::memory_order_relaxed) < total) {
+      auto got = ring->nb_read(buf.data(), batch);
+      if (got == 0) {
+        bsl::cpu_relax();
+        continue;
+      }
+      auto now = bsl::rdcycle();
+      for (uint64_t i = 0; i < got; ++i) {
+        auto &item = buf[i];
+        ledger.deliver(item);
+        if (item.producer < prod) {
+          if ((int64_t)item.seq <= last[item.producer]) {
+            std::printf("  reordered %u:%u after %ld\n", item.producer,
+                        item.seq, (long)last[item.producer]);
+            failed = true;
+          }
+          last[item.producer] = item.seq;
+        }
+        my_lat.push_back(now - item.stamp);
+      }
+      consumed.fetch_add(got, std::memory_order_relaxed);
+    }
+  });
+
+  ledger.check();
+  std::vector<uint64_t> all;
+  for (auto &l : lat) {
+    all.insert(all.end(), l.begin(), l.end());
+  }
+  char name[32];
+  std::snprintf(name, sizeof(name), "ring%lu", (unsigned long)Sz);
+  report(name, prod, cons, batch, ns, all);
+}
+
+// ll_t pushes from every producer, pops from one consumer
+void ll_case(unsigned prod) {
+  using node_t = bsl::lln_t<item_t>;
+  std::unique_ptr<node_t[]> nodes(new node_t[prod * per_producer]);
+  bsl::ll_t<item_t> list;
+  ledger_t ledger(prod);
+  auto total = prod * per_producer;
+
+  auto ns = bsl_bench::launch(prod + 1, [&](unsigned t) {
+    if (t < prod) {
+      for (uint64_t seq = 0; seq < per_producer; ++seq) {
+        auto &node = nodes[t * per_producer + seq];
+        node.value() = {t, (uint32_t)seq, 0};
+        list.push(node);
+      }
+      return;
+    }
+    for (uint64_t got = 0; got < total;) {
+      auto *node = list.pop();
+      if (node == PTR_FAIL) {
+        bsl::cpu_relax();
+        continue;
+      }
+      ledger.deliver(node->value());
+      ++got;
+    }
+  });
+
+  ledger.check();
+  if (!list.empty()) {
+    std::printf("  list not drained\n");
+    failed = true;
+  }
+  std::vector<uint64_t> none;
+  report("ll", prod, 1, 1, ns, none);
+}
+
+}  // namespace
+
+// usage: mpmc [max_threads] [items_per_producer]
+int main(int argc, char **argv) {
+  unsigned max_threads = argc > 1 ? (unsigned)std::atoi(argv[1])
+                                  : std::thread::hardware_concurrency();
+  if (argc > 2) {
+    per_producer = (uint64_t)std::atoll(argv[2]);
+  }
+  max_threads = std::max(max_threads, 1U);
+  cycle_hz = bsl_bench::calibrate_hz();
+
+  for (unsigned prod = 1;; prod = std::min(prod * 2, max_threads)) {
+    for (unsigned cons = 1;; cons = std::min(cons * 2, max_threads)) {
+      for (uint64_t batch : {1, 8, 32}) {
+        ring_case<64>(prod, cons, batch);
+        ring_case<1024>(prod, cons, batch);
+      }
+      if (cons == max_threads) {
+        break;
+      }
+    }
+    ll_case(prod);
+    if (prod == max_threads) {
+      break;
+    }
+  }
+  if (failed) {
+    std::printf("FAILED\n");
+    return 1;
+  }
+  return 0;
+}
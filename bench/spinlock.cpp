@@ -0,0 +1,76 @@
+// contention benchmark for the spinlock family, hosted linux
+// each thread repeatedly takes the lock, bumps a shared counter and
+// releases it, reports lock acquisitions per second and its inverse, the
+// mean time per acquisition, for 1..N pinned threads
+
+#include "host.h"
+
+#include <bsl/spinlock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+constexpr uint64_t ops_per_thread = 100000;
+
+template <typename Fn>
+void run(const char *name, unsigned threads, Fn &&critical) {
+  auto ns = bsl_bench::launch(threads, [&](unsigned) {
+    for (uint64_t i = 0; i < ops_per_thread; ++i) {
+      critical();
+    }
+  });
+  auto ops = (double)(ops_per_thread * threads);
+  std::printf("%-8s threads=%-3u %10.0f ops/s %8.1f ns/op\n", name,
+              threads, ops / ns * 1e9, ns / ops);
+}
+
+}  // namespace
+
+// usage: spinlock [max_threads]
+int main(int argc, char **argv) {
+  unsigned max_threads = argc > 1 ? (unsigned)std::atoi(argv[1])
+                                  : std::thread::hardware_concurrency();
+  if (max_threads == 0) {
+    std::fprintf(stderr, "usage: %s [max_threads > 0]\n", argv[0]);
+    return 2;
+  }
+  for (unsigned n = 1;; n = std::min(n * 2, max_threads)) {
+    uint64_t counter = 0;
+
+    bsl::ticket_lock_t<> ticket;
+    run("ticket", n, [&] {
+      bsl::lock_guard_t guard(ticket);
+      ++counter;
+    });
+
+    bsl::mcs_lock_t<> mcs;
+    run("mcs", n, [&] {
+      bsl::mcs_guard_t guard(mcs);
+      ++counter;
+    });
+
+    bsl::rw_lock_t<> rw;
+    run("rw-write", n, [&] {
+      bsl::lock_guard_t guard(rw);
+      ++counter;
+    });
+    run("rw-read", n, [&] {
+      bsl::shared_guard_t guard(rw);
+      [[maybe_unused]] volatile auto val = counter;
+    });
+
+    if (counter != ops_per_thread * n * 3) {
+      std::printf("lost updates: %lu\n", (unsigned long)counter);
+      return 1;
+    }
+    if (n == max_threads) {
+      break;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,121 @@
+// stealing throughput benchmark and stress test for ws_deque_t, hosted linux
+// one pinned owner pushes work items in bursts and pops them back while
+// pinned thieves steal from the top, sweeps the thief count and burst size,
+// checks every item is taken exactly once, reports items/s, the share taken
+// by thieves and the rate of steals aborted by a lost race
+
+#include "host.h"
+
+#include <bsl/cpu.h>
+#include <bsl/ws_deque.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+namespace {
+
+uint64_t total_items = 1000000;
+// set from any thread on a violation
+std::atomic<bool> failed{false};
+
+// burst: items pushed before the owner drains its own deque
+void run(unsigned thieves, uint64_t burst) {
+  bsl::ws_deque_t<uint64_t> deque;
+  std::unique_ptr<std::atomic<uint8_t>[]> seen(
+      new std::atomic<uint8_t>[total_items]());
+  std::atomic<uint64_t> taken{0};
+  std::atomic<uint64_t> stolen{0};
+  std::atomic<uint64_t> aborted{0};
+
+  auto take = [&](uint64_t item) {
+    if (item >= total_items || seen[item].fetch_add(1) != 0) {
+      std::printf("  item %lu taken twice\n", (unsigned long)item);
+      failed = true;
+    }
+    taken.fetch_add(1, std::memory_order_relaxed);
+  };
+
+  // thread 0 owns the deque, the others steal from it
+  auto ns = bsl_bench::launch(thieves + 1, [&](unsigned t) {
+    if (t == 0) {
+      for (uint64_t next = 0; next < total_items;) {
+        auto end = std::min(next + burst, total_items);
+        for (; next < end; ++next) {
+          if (!deque.push(next)) {
+            std::printf("  push failed\n");
+            failed = true;
+          }
+        }
+        uint64_t item = 0;
+        while (deque.pop(item)) {
+          take(item);
+        }
+      }
+      return;
+    }
+    uint64_t my_stolen = 0;
+    uint64_t my_aborted = 0;
+    while (taken.load(std::memory_order_relaxed) < total_items) {
+      uint64_t item = 0;
+      switch (deque.steal(item)) {
+        case bsl::WS_SUCCESS:
+          take(item);
+          ++my_stolen;
+          break;
+        case bsl::WS_ABORT:
+          ++my_aborted;
+          break;
+        case bsl::WS_EMPTY:
+          bsl::cpu_relax();
+          break;
+      }
+    }
+    stolen.fetch_add(my_stolen);
+    aborted.fetch_add(my_aborted);
+  });
+
+  for (uint64_t i = 0; i < total_items; ++i) {
+    if (seen[i].load() != 1) {
+      std::printf("  item %lu lost\n", (unsigned long)i);
+      failed = true;
+      break;
+    }
+  }
+  auto steals = (double)stolen.load();
+  auto attempts = steals + (double)aborted.load();
+  std::printf(
+      "thieves=%-3u burst=%-5lu %11.0f items/s  stolen %5.1f%%  aborted "
+      "%5.1f%%\n",
+      thieves, (unsigned long)burst, (double)total_items / ns * 1e9,
+      steals * 100 / (double)total_items,
+      attempts != 0 ? (double)aborted.load() * 100 / attempts : 0.0);
+}
+
+}  // namespace
+
+// usage: steal [max_thieves] [items]
+int main(int argc, char **argv) {
+  unsigned max_thieves = argc > 1 ? (unsigned)std::atoi(argv[1])
+                                  : std::thread::hardware_concurrency() - 1;
+  if (argc > 2) {
+    total_items = (uint64_t)std::atoll(argv[2]);
+  }
+  for (unsigned thieves = 0;; thieves = std::min(std::max(thieves * 2, 1U),
+                                                 max_thieves)) {
+    for (uint64_t burst : {1, 64, 4096}) {
+      run(thieves, burst);
+    }
+    if (thieves == max_thieves) {
+      break;
+    }
+  }
+  if (failed) {
+    std::printf("FAILED\n");
+    return 1;
+  }
+  return 0;
+}
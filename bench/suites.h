@@ -0,0 +1,140 @@
+#pragma once
+
+// benchmark suites for the core bsl primitives, shared by the hosted
+// driver (bench/main.cpp) and bare metal images, each suite takes a
+// bench_t and reports one line per case
+
+#include <bsl/bench.h>
+#include <bsl/cdll.h>
+#include <bsl/charconv.h>
+#include <bsl/cstring.h>
+#include <bsl/hash.h>
+#include <bsl/ring_buf.h>
+#include <config.h>
+
+namespace bsl_bench {
+
+template <typename Bench>
+void ring_buf_suite(Bench &bench) {
+  static bsl::ring_buf_t<uint64_t, 1024> ring;
+  uint64_t val = 0;
+  bench.run("ring_buf.write_read", [&] {
+    ring.nb_write(&val, 1);
+    ring.nb_read(&val, 1);
+    bsl::do_not_optimize(val);
+  });
+  uint64_t batch[32] = {};
+  bench.run("ring_buf.write_read_32", [&] {
+    ring.nb_write(batch, 32);
+    ring.nb_read(batch, 32);
+    bsl::do_not_optimize(batch);
+  });
+}
+
+template <typename Bench>
+void cdll_suite(Bench &bench) {
+  static bsl::cdlln_t<uint64_t> nodes[64];
+  bsl::cdll_t<uint64_t> list(bsl::in_place);
+  bsl::counted_cdll_t<uint64_t> counted(bsl::in_place);
+  for (uint64_t i = 0; i < 64; ++i) {
+    nodes[i].value() = bsl::hash64(i);
+    list.push_back(nodes[i]);
+  }
+  bench.run("cdll.pop_push", [&] { list.push_back(list.pop_front()); });
+  bench.run("cdll.size_64", [&] { bsl::do_not_optimize(list.size()); });
+  // re-key before each sort so it never sees sorted input, the 64 hashes
+  // are part of the timing
+  uint64_t seed = 64;
+  bench.run("cdll.sort_64", [&] {
+    for (auto &node : list) {
+      node.value() = bsl::hash64(seed++);
+    }
+    list.sort();
+  });
+  list.init();
+  for (auto &node : nodes) {
+    counted.push_back(node);
+  }
+  bench.run("counted_cdll.size_64",
+            [&] { bsl::do_not_optimize(counted.size()); });
+}
+
+template <typename Bench>
+void charconv_suite(Bench &bench) {
+  char buf[32];
+  uint64_t val = 1234567890123ULL;
+  bench.run("to_chars.u64", [&] {
+    bsl::do_not_optimize(val);
+    bsl::do_not_optimize(bsl::to_chars(buf, sizeof(buf), val));
+  });
+  bench.run("to_chars.u64_hex", [&] {
+    bsl::do_not_optimize(val);
+    bsl::do_not_optimize(bsl::to_chars(buf, sizeof(buf), val, 16));
+  });
+  const char *digits = "1234567890123";
+  bench.run("from_chars.u64", [&] {
+    bsl::do_not_optimize(digits);
+    bsl::do_not_optimize(bsl::from_chars(digits, 13, val));
+  });
+}
+
+template <typename Bench>
+void hash_suite(Bench &bench) {
+  uint64_t val = 1;
+  bench.run("hash64", [&] { val = bsl::hash64(val); });
+  bsl::do_not_optimize(val);
+  const char *key = "/cpus/cpu@0/interrupt-controller";
+  bench.run("hash_sv.32", [&] {
+    bsl::do_not_optimize(key);
+    bsl::do_not_optimize(bsl::hash_sv(key));
+  });
+}
+
+template <typename Bench>
+void cstring_suite(Bench &bench) {
+  alignas(64) static char src[256];
+  alignas(64) static char dst[256];
+  for (size_t i = 0; i < sizeof(src) - 1; ++i) {
+    src[i] = (char)('a' + i % 26);
+  }
+  bench.run("memcpy.64", [&] {
+    bsl::do_not_optimize(src);
+    bsl::memcpy(dst, src, 64);
+  });
+  bench.run("memcpy.256", [&] {
+    bsl::do_not_optimize(src);
+    bsl::memcpy(dst, src, 256);
+  });
+  bench.run("memset.256", [&] {
+    bsl::do_not_optimize(dst);
+    bsl::memset(dst, 0, 256);
+  });
+  bench.run("memcmp.64", [&] {
+    bsl::do_not_optimize(src);
+    bsl::do_not_optimize(bsl::memcmp(dst, src, 64));
+  });
+  bench.run("memchr.255", [&] {
+    bsl::do_not_optimize(src);
+    bsl::do_not_optimize(bsl::memchr(src, 0, 256));
+  });
+  bench.run("strlen.255", [&] {
+    bsl::do_not_optimize(src);
+    bsl::do_not_optimize(bsl::strlen(src));
+  });
+  bench.run("strcmp.255", [&] {
+    bsl::do_not_optimize(src);
+    bsl::do_not_optimize(bsl::strcmp(src, src + 26));
+  });
+}
+
+template <typename Bench>
+void run_all(Bench &bench) {
+  bench.header();
+  ring_buf_suite(bench);
+  cdll_suite(bench);
+  charconv_suite(bench);
+  hash_suite(bench);
+  cstring_suite(bench);
+}
+
+}  // namespace bsl_bench
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <bsl/align.h>
+#include <config.h>
+
+#include <concepts>
+#include <cstddef>
+#include <new>
+
+namespace bsl {
+
+// allocator interface used by bsl containers
+// allocate returns nullptr on failure, never throws
+template <typename T>
+concept allocator = requires(T alloc, void *ptr, size_t size, size_t align) {
+  { alloc.allocate(size, align) } noexcept -> std::same_as<void *>;
+  { alloc.deallocate(ptr, size, align) } noexcept;
+};
+
+// global heap, nothrow new / delete
+struct heap_alloc_t {
+  [[nodiscard]] void *allocate(size_t size, size_t align) noexcept {
+    return ::operator new(size, std::align_val_t(align), std::nothrow);
+  }
+  void deallocate(void *ptr, [[maybe_unused]] size_t size,
+                  size_t align) noexcept {
+    ::operator delete(ptr, std::align_val_t(align));
+  }
+};
+
+// bump allocator over caller provided memory
+// deallocate is a no-op, memory is released all at once by reset
+class arena_t {
+ private:
+  char *base = nullptr;
+  char *cur = nullptr;
+  char *end = nullptr;
+
+ public:
+  arena_t() noexcept = default;
+  arena_t(void *mem, size_t size) noexcept
+      : base((char *)mem), cur((char *)mem), end((char *)mem + size) {}
+  arena_t(const arena_t &) = delete;
+  arena_t(arena_t &&) = delete;
+  arena_t &operator=(const arena_t &) = delete;
+  arena_t &operator=(arena_t &&) = delete;
+
+  [[nodiscard]] void *allocate(size_t size, size_t align) noexcept {
+    auto *ptr = p2align_up(cur, align);
+    if (ptr > end || (size_t)(end - ptr) < size) [[unlikely]] {
+      return nullptr;
+    }
+    cur = ptr + size;
+    return ptr;
+  }
+  void deallocate([[maybe_unused]] void *ptr, [[maybe_unused]] size_t size,
+                  [[maybe_unused]] size_t align) noexcept {}
+
+  void reset() noexcept { cur = base; }
+  [[nodiscard]] size_t used() const noexcept { return (size_t)(cur - base); }
+};
+
+// fixed size blocks over caller provided memory, free blocks are chained
+// through their first word, allocate fails on requests larger than a block
+class pool_t {
+ private:
+  static constexpr size_t ALIGN = alignof(std::max_align_t);
+
+  struct free_t {
+    free_t *next;
+  };
+  free_t *head = nullptr;
+  size_t block = 0;
+
+ public:
+  pool_t() noexcept = default;
+  /**
+   * @param mem backing memory
+   * @param size bytes of mem
+   * @param block block size, rounded up to max_align_t alignment
+   */
+  pool_t(void *mem, size_t size, size_t block) noexcept
+      : block(p2align_up(block > 0 ? block : 1, ALIGN)) {
+    auto *cur = p2align_up((char *)mem, ALIGN);
+    auto *end = (char *)mem + size;
+    while (cur <= end && (size_t)(end - cur) >= this->block) {
+      deallocate(cur, this->block, ALIGN);
+      cur += this->block;
+    }
+  }
+  pool_t(const pool_t &) = delete;
+  pool_t(pool_t &&) = delete;
+  pool_t &operator=(const pool_t &) = delete;
+  pool_t &operator=(pool_t &&) = delete;
+
+  [[nodiscard]] void *allocate(size_t size, size_t align) noexcept {
+    if (size > block || align > ALIGN || head == nullptr) [[unlikely]] {
+      return nullptr;
+    }
+    auto *ret = head;
+    head = head->next;
+    return ret;
+  }
+  void deallocate(void *ptr, [[maybe_unused]] size_t size,
+                  [[maybe_unused]] size_t align) noexcept {
+    auto *node = (free_t *)ptr;
+    node->next = head;
+    head = node;
+  }
+
+  [[nodiscard]] size_t block_size() const noexcept { return block; }
+};
+
+// non-owning handle, lets containers share one stateful allocator
+template <allocator Alloc>
+class alloc_ref_t {
+ private:
+  Alloc *alloc = nullptr;
+
+ public:
+  alloc_ref_t() noexcept = default;
+  alloc_ref_t(Alloc &alloc) noexcept : alloc(&alloc) {}
+
+  [[nodiscard]] void *allocate(size_t size, size_t align) noexcept {
+    return alloc->allocate(size, align);
+  }
+  void deallocate(void *ptr, size_t size, size_t align) noexcept {
+    alloc->deallocate(ptr, size, align);
+  }
+};
+
+}  // namespace bsl
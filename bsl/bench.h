@@ -0,0 +1,178 @@
+#pragma once
+
+/*
+Microbenchmark Harness
+Times a callable with the cycle counter (rdcycle), Samples runs of Iters
+calls each, the cost of an empty timed loop is measured once and
+subtracted, reports the median and p99 per call in counter ticks and ns
+
+Works hosted and on bare metal, output goes through any char_dev_t, the
+text format is for people, the csv format is one stable line per benchmark
+for collecting results over time
+
+  bsl::bench_t bench(uart, freq_hz);
+  bench.run("hash64", [&] { val = bsl::hash64(val); });
+*/
+
+#include <bsl/char_dev.h>
+#include <bsl/charconv.h>
+#include <bsl/cpu.h>
+#include <bsl/string_view.h>
+#include <config.h>
+
+#include <algorithm>
+
+namespace bsl {
+
+enum bench_fmt : uint8_t {
+  BENCH_TEXT = 0,
+  BENCH_CSV = 1,
+};
+
+// keep val alive and opaque to the optimizer
+template <typename T>
+FORCE_INLINE void do_not_optimize(const T &val) noexcept {
+  asm volatile("" : : "r,m"(val) : "memory");
+}
+// make memory writes observable
+FORCE_INLINE void clobber_memory() noexcept { asm volatile("" ::: "memory"); }
+
+// per call cost, fixed point with 2 decimals
+struct bench_result_t {
+  uint64_t median_centi = 0;
+  uint64_t p99_centi = 0;
+  uint64_t median_ns_centi = 0;
+};
+
+/**
+ * @brief benchmark runner
+ * @tparam Dev char_dev_t implementation used for output
+ * @tparam Samples timed samples per benchmark
+ */
+template <typename Dev, size_t Samples = 101>
+class bench_t {
+  static_assert(Samples > 0, "need at least one sample");
+
+  char_dev_t<Dev> &dev;
+  uint64_t hz;
+  uint64_t iters;
+  bench_fmt fmt;
+  uint64_t overhead = 0;
+  uint64_t samples[Samples] = {};
+
+  template <typename Fn>
+  NOINLINE uint64_t sample(Fn &fn) noexcept {
+    auto st = rdcycle();
+    for (uint64_t i = 0; i < iters; ++i) {
+      fn();
+      clobber_memory();
+    }
+    return rdcycle() - st;
+  }
+
+  // index of the q-th percentile in the sorted samples
+  static constexpr size_t rank(size_t q) noexcept {
+    return (Samples - 1) * q / 100;
+  }
+
+  void put_u64(uint64_t val) noexcept {
+    char buf[24];
+    dev.write(buf, to_chars(buf, sizeof(buf), val));
+  }
+  // centi as x.yy, right aligned to width
+  void put_fixed(uint64_t centi, size_t width = 0) noexcept {
+    char buf[32];
+    auto len = to_chars(buf, sizeof(buf) - 3, centi / 100);
+    buf[len++] = '.';
+    buf[len++] = (char)('0' + centi / 10 % 10);
+    buf[len++] = (char)('0' + centi % 10);
+    for (auto i = len; i < width; ++i) {
+      dev.write(" ");
+    }
+    dev.write(buf, len);
+  }
+  void put_padded(sv_t str, size_t width) noexcept {
+    dev.write(str);
+    for (auto i = str.size(); i < width; ++i) {
+      dev.write(" ");
+    }
+  }
+
+ public:
+  /**
+   * @param dev output device
+   * @param hz rdcycle() frequency, 0 leaves ns unreported
+   * @param iters calls per sample, enough to dwarf the counter resolution
+   * @param fmt output format
+   */
+  bench_t(char_dev_t<Dev> &dev, uint64_t hz, uint64_t iters = 1000,
+          bench_fmt fmt = BENCH_TEXT) noexcept
+      : dev(dev), hz(hz), iters(iters > 0 ? iters : 1), fmt(fmt) {
+    auto empty = [] {};
+    for (auto &s : samples) {
+      s = sample(empty);
+    }
+    std::sort(samples, samples + Samples);
+    overhead = samples[rank(50)];
+  }
+  bench_t(const bench_t &) = delete;
+  bench_t &operator=(const bench_t &) = delete;
+
+  // column header, once before the first run
+  void header() noexcept {
+    if (fmt == BENCH_CSV) {
+      dev.write("name,iters,samples,median_ticks,p99_ticks,median_ns\n");
+    } else {
+      put_padded("name", 32);
+      dev.write("  median ticks     p99 ticks       ns/op\n");
+    }
+  }
+
+  /**
+   * @brief time fn, report one line
+   * @param name benchmark name, no commas for csv
+   * @param fn callable run Samples * iters times
+   */
+  template <typename Fn>
+  bench_result_t run(sv_t name, Fn &&fn) noexcept {
+    // warm caches and branch predictors
+    sample(fn);
+    for (auto &s : samples) {
+      auto cyc = sample(fn);
+      s = cyc > overhead ? (cyc - overhead) * 100 / iters : 0;
+    }
+    std::sort(samples, samples + Samples);
+
+    bench_result_t ret;
+    ret.median_centi = samples[rank(50)];
+    ret.p99_centi = samples[rank(99)];
+    if (hz != 0) {
+      ret.median_ns_centi =
+          (uint64_t)((uint128_t)ret.median_centi * 1000000000U / hz);
+    }
+
+    if (fmt == BENCH_CSV) {
+      dev.write(name);
+      dev.write(",");
+      put_u64(iters);
+      dev.write(",");
+      put_u64(Samples);
+      dev.write(",");
+      put_fixed(ret.median_centi);
+      dev.write(",");
+      put_fixed(ret.p99_centi);
+      dev.write(",");
+      put_fixed(ret.median_ns_centi);
+      dev.write("\n");
+    } else {
+      put_padded(name, 32);
+      put_fixed(ret.median_centi, 14);
+      put_fixed(ret.p99_centi, 14);
+      put_fixed(ret.median_ns_centi, 12);
+      dev.write("\n");
+    }
+    return ret;
+  }
+};
+
+}  // namespace bsl
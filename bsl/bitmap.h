@@ -0,0 +1,290 @@
+#pragma once
+
+/*
+Bitmaps
+bitmap_t<N> holds N bits inline, bitmap_view_t works over caller owned
+uint64_t words, e.g. a page frame map in reserved memory, both share one
+implementation
+
+Searches scan 64 bits per step and skip runs of all-zero / all-one words a
+vector at a time, range set / clear touch the partial edge words with masks
+and fill the words in between, searches return size() when nothing is found
+
+atomic_bitmap_t / atomic_bitmap_view_t give lock-free single bit updates
+and alloc(), which claims a clear bit with a CAS on its word, for ids, IRQ
+vectors and slot occupancy
+*/
+
+#include <bsl/simd.h>
+#include <config.h>
+
+#include <atomic>
+#include <bit>
+
+namespace bsl {
+
+constexpr size_t bitmap_words(size_t bits) noexcept { return (bits + 63) / 64; }
+
+// mask of the valid bits in the last word of an nbits map
+constexpr uint64_t bitmap_tail_mask(size_t nbits) noexcept {
+  return nbits % 64 == 0 ? ~0ULL : (1ULL << (nbits % 64)) - 1;
+}
+
+// words stored inline
+template <typename Word, size_t N>
+class bitmap_inline_t {
+ protected:
+  Word map[bitmap_words(N)] = {};
+
+  Word *words() noexcept { return map; }
+  const Word *words() const noexcept { return map; }
+
+ public:
+  [[nodiscard]] static constexpr size_t size() noexcept { return N; }
+};
+
+// words owned by the caller
+template <typename Word>
+class bitmap_extern_t {
+ protected:
+  Word *map = nullptr;
+  size_t nbits = 0;
+
+  Word *words() noexcept { return map; }
+  const Word *words() const noexcept { return map; }
+
+ public:
+  bitmap_extern_t() noexcept = default;
+  /**
+   * @param words bitmap_words(nbits) words, bits past nbits must be clear
+   * @param nbits number of bits
+   */
+  bitmap_extern_t(Word *words, size_t nbits) noexcept
+      : map(words), nbits(nbits) {}
+
+  [[nodiscard]] size_t size() const noexcept { return nbits; }
+};
+
+template <typename Store>
+class basic_bitmap_t : public Store {
+  using Store::words;
+
+  /**
+   * @brief first index in [i, end) whose word differs from fill
+   * @return end if every word equals fill
+   */
+  static size_t skip_words(const uint64_t *map, size_t i, size_t end,
+                           uint64_t fill) noexcept {
+    constexpr auto step = SIMD_WIDTH / sizeof(uint64_t);
+    auto fv = u8xw_t{} + (uint8_t)fill;
+    for (; i + step <= end; i += step) {
+      auto eq = simd_load<u8xw_t>(map + i) == fv;
+      if (simd_mask((u8xw_t)eq) != SIMD_FULL_MASK<u8xw_t>) {
+        break;
+      }
+    }
+    while (i < end && map[i] == fill) {
+      ++i;
+    }
+    return i;
+  }
+
+  // next set bit of (word ^ invert) at or after pos
+  size_t find_next(size_t pos, uint64_t invert) const noexcept {
+    auto nbits = this->size();
+    if (pos >= nbits) {
+      return nbits;
+    }
+    const auto *map = words();
+    auto end = bitmap_words(nbits);
+    auto i = pos / 64;
+    auto word = (map[i] ^ invert) & (~0ULL << (pos % 64));
+    while (word == 0) {
+      i = skip_words(map, i + 1, end, invert);
+      if (i == end) {
+        return nbits;
+      }
+      word = map[i] ^ invert;
+    }
+    // clear padding bits read as zeros past the end
+    auto ret = i * 64 + (size_t)std::countr_zero(word);
+    return ret < nbits ? ret : nbits;
+  }
+
+ public:
+  using Store::Store;
+  using Store::size;
+
+  [[nodiscard]] bool test(size_t pos) const noexcept {
+    return ((words()[pos / 64] >> (pos % 64)) & 1U) != 0;
+  }
+  void set(size_t pos) noexcept { words()[pos / 64] |= 1ULL << (pos % 64); }
+  void clear(size_t pos) noexcept {
+    words()[pos / 64] &= ~(1ULL << (pos % 64));
+  }
+
+  /**
+   * @brief set bits [pos, pos + len), caller keeps the range in bounds
+   */
+  void set_range(size_t pos, size_t len) noexcept {
+    if (len == 0) {
+      return;
+    }
+    auto *map = words();
+    auto first = pos / 64;
+    auto last = (pos + len - 1) / 64;
+    auto head = ~0ULL << (pos % 64);
+    auto tail = ~0ULL >> ((64 - (pos + len) % 64) % 64);
+    if (first == last) {
+      map[first] |= head & tail;
+      return;
+    }
+    map[first] |= head;
+    for (auto i = first + 1; i < last; ++i) {
+      map[i] = ~0ULL;
+    }
+    map[last] |= tail;
+  }
+
+  /**
+   * @brief clear bits [pos, pos + len), caller keeps the range in bounds
+   */
+  void clear_range(size_t pos, size_t len) noexcept {
+    if (len == 0) {
+      return;
+    }
+    auto *map = words();
+    auto first = pos / 64;
+    auto last = (pos + len - 1) / 64;
+    auto head = ~0ULL << (pos % 64);
+    auto tail = ~0ULL >> ((64 - (pos + len) % 64) % 64);
+    if (first == last) {
+      map[first] &= ~(head & tail);
+      return;
+    }
+    map[first] &= ~head;
+    for (auto i = first + 1; i < last; ++i) {
+      map[i] = 0;
+    }
+    map[last] &= ~tail;
+  }
+
+  [[nodiscard]] size_t find_first_set() const noexcept {
+    return find_next(0, 0);
+  }
+  [[nodiscard]] size_t find_next_set(size_t pos) const noexcept {
+    return find_next(pos, 0);
+  }
+  [[nodiscard]] size_t find_first_zero() const noexcept {
+    return find_next(0, ~0ULL);
+  }
+  [[nodiscard]] size_t find_next_zero(size_t pos) const noexcept {
+    return find_next(pos, ~0ULL);
+  }
+
+  /**
+   * @brief find len consecutive clear bits
+   * @param len run length
+   * @param pos lowest start considered
+   * @return start of the first run, size() if none
+   */
+  [[nodiscard]] size_t find_zero_run(size_t len, size_t pos = 0) const noexcept {
+    auto nbits = this->size();
+    while (true) {
+      auto start = find_next_zero(pos);
+      if (start >= nbits || nbits - start < len) {
+        return nbits;
+      }
+      auto stop = find_next_set(start);
+      if (stop - start >= len) {
+        return start;
+      }
+      pos = stop;
+    }
+  }
+
+  [[nodiscard]] size_t count() const noexcept {
+    const auto *map = words();
+    size_t ret = 0;
+    for (size_t i = 0, end = bitmap_words(this->size()); i < end; ++i) {
+      ret += (size_t)std::popcount(map[i]);
+    }
+    return ret;
+  }
+  [[nodiscard]] bool none() const noexcept {
+    return find_first_set() == this->size();
+  }
+};
+
+template <typename Store>
+class basic_atomic_bitmap_t : public Store {
+  using Store::words;
+
+  std::atomic<uint64_t> &word(size_t pos) noexcept {
+    return words()[pos / 64];
+  }
+
+ public:
+  using Store::Store;
+  using Store::size;
+
+  [[nodiscard]] bool test(size_t pos) const noexcept {
+    auto val = words()[pos / 64].load(std::memory_order_acquire);
+    return ((val >> (pos % 64)) & 1U) != 0;
+  }
+  // return the previous state of the bit
+  bool set(size_t pos) noexcept {
+    auto bit = 1ULL << (pos % 64);
+    return (word(pos).fetch_or(bit, std::memory_order_acq_rel) & bit) != 0;
+  }
+  bool clear(size_t pos) noexcept {
+    auto bit = 1ULL << (pos % 64);
+    return (word(pos).fetch_and(~bit, std::memory_order_acq_rel) & bit) != 0;
+  }
+
+  /**
+   * @brief claim a clear bit
+   * @param hint bit to start searching from, spreads concurrent allocators
+   * @return claimed bit, size() if the map is full
+   */
+  size_t alloc(size_t hint = 0) noexcept {
+    auto nbits = size();
+    auto end = bitmap_words(nbits);
+    auto start = hint < nbits ? hint / 64 : 0;
+    auto *map = words();
+    for (size_t k = 0; k < end; ++k) {
+      auto i = start + k < end ? start + k : start + k - end;
+      auto valid = i == end - 1 ? bitmap_tail_mask(nbits) : ~0ULL;
+      auto cur = map[i].load(std::memory_order_relaxed);
+      while (true) {
+        auto avail = ~cur & valid;
+        if (avail == 0) {
+          break;
+        }
+        auto bit = avail & (0 - avail);
+        if (map[i].compare_exchange_weak(cur, cur | bit,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+          return i * 64 + (size_t)std::countr_zero(bit);
+        }
+      }
+    }
+    return nbits;
+  }
+
+  // release a bit claimed by alloc()
+  void free(size_t pos) noexcept {
+    word(pos).fetch_and(~(1ULL << (pos % 64)), std::memory_order_release);
+  }
+};
+
+template <size_t N>
+using bitmap_t = basic_bitmap_t<bitmap_inline_t<uint64_t, N>>;
+using bitmap_view_t = basic_bitmap_t<bitmap_extern_t<uint64_t>>;
+template <size_t N>
+using atomic_bitmap_t =
+    basic_atomic_bitmap_t<bitmap_inline_t<std::atomic<uint64_t>, N>>;
+using atomic_bitmap_view_t =
+    basic_atomic_bitmap_t<bitmap_extern_t<std::atomic<uint64_t>>>;
+
+}  // namespace bsl
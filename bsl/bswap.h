@@ -1,9 +1,14 @@
 #pragma once
 
+#include <bsl/simd.h>
 #include <config.h>
 
+#include <concepts>
+
 namespace bsl {
 
+FORCE_INLINE constexpr uint8_t bswap(uint8_t x) noexcept { return x; }
+
 FORCE_INLINE constexpr uint16_t bswap(uint16_t x) noexcept {
   return __builtin_bswap16(x);
 }
@@ -16,6 +21,8 @@ FORCE_INLINE constexpr uint64_t bswap(uint64_t x) noexcept {
   return __builtin_bswap64(x);
 }
 
+FORCE_INLINE constexpr int8_t bswap(int8_t x) noexcept { return x; }
+
 FORCE_INLINE constexpr int16_t bswap(int16_t x) noexcept {
   return (int16_t)__builtin_bswap16((uint16_t)x);
 }
@@ -28,4 +35,41 @@ FORCE_INLINE constexpr int64_t bswap(int64_t x) noexcept {
   return (int64_t)__builtin_bswap64((uint64_t)x);
 }
 
-}  // namespace bsl
\ No newline at end of file
+// byte swap every Sz byte lane of a 16 byte vector
+// lowered to pshufb on x86, rev16 / rev32 / rev64 on arm
+template <size_t Sz>
+FORCE_INLINE u8x16_t bswap_vec(u8x16_t v) noexcept {
+  if constexpr (Sz == 2) {
+    return __builtin_shufflevector(v, v, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10,
+                                   13, 12, 15, 14);
+  } else if constexpr (Sz == 4) {
+    return __builtin_shufflevector(v, v, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8,
+                                   15, 14, 13, 12);
+  } else {
+    static_assert(Sz == 8, "lane size must be 2, 4 or 8");
+    return __builtin_shufflevector(v, v, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13,
+                                   12, 11, 10, 9, 8);
+  }
+}
+
+/**
+ * @brief byte swap an array, 16 bytes per step
+ * @param dst destination, may equal src but not partially overlap it
+ * @param src source
+ * @param n number of elements
+ */
+template <std::integral T>
+INLINE void bswap_n(T *dst, const T *src, size_t n) noexcept {
+  size_t i = 0;
+  if constexpr (sizeof(T) > 1) {
+    constexpr size_t lanes = sizeof(u8x16_t) / sizeof(T);
+    for (; i + lanes <= n; i += lanes) {
+      simd_store(dst + i, bswap_vec<sizeof(T)>(simd_load<u8x16_t>(src + i)));
+    }
+  }
+  for (; i < n; ++i) {
+    dst[i] = bswap(src[i]);
+  }
+}
+
+}  // namespace bsl
@@ -0,0 +1,317 @@
+#pragma once
+
+/*
+Intrusive Cache
+Scan resistant 2Q replacement over intrusive cdll_t recency lists, with an
+intrusive chained hash index, cached objects derive from cache_node_t and
+are owned by the caller, the cache never allocates
+
+New entries enter the probation queue, a hit on probation promotes the
+entry to the protected queue, eviction takes the probation tail while
+probation holds more than its share (1/4 of capacity) or protected is
+empty, so a one-time scan only churns probation and never flushes the hot
+set, touch, insert and evict are O(1)
+
+sharded_cache_t splits the key space over independently locked shards
+*/
+
+#include <bsl/cdll.h>
+#include <bsl/hash.h>
+#include <config.h>
+
+#include <type_traits>
+#include <utility>
+
+namespace bsl {
+
+template <typename T, typename Key, size_t Buckets, typename Evict,
+          typename Hash>
+class cache_t;
+
+// cache bookkeeping, embed by deriving from it
+template <typename Key>
+class cache_node_t {
+  template <typename T, typename _Key, size_t Buckets, typename Evict,
+            typename Hash>
+  friend class cache_t;
+
+ private:
+  // must stay the first member, list nodes are cast back to cache_node_t
+  cdlln_t<> link;
+  cache_node_t *hnext = nullptr;
+  Key key{};
+  uint8_t queue = 0;
+
+ public:
+  cache_node_t() noexcept = default;
+  cache_node_t(const cache_node_t &) = delete;
+  cache_node_t(cache_node_t &&) = delete;
+  cache_node_t &operator=(const cache_node_t &) = delete;
+  cache_node_t &operator=(cache_node_t &&) = delete;
+
+  [[nodiscard]] const Key &cache_key() const noexcept { return key; }
+  [[nodiscard]] bool cached() const noexcept { return queue != 0; }
+};
+
+// eviction callback doing nothing
+struct no_evict_t {
+  void operator()(void *) const noexcept {}
+};
+
+/**
+ * @brief intrusive 2Q cache
+ * @tparam T cached type, derives from cache_node_t<Key>
+ * @tparam Buckets hash bucket count, power of 2
+ * @tparam Evict evict(T *) is called on every evicted entry
+ */
+template <typename T, typename Key, size_t Buckets,
+          typename Evict = no_evict_t, typename Hash = hash_t<Key>>
+class cache_t {
+  static_assert(Buckets > 0 && (Buckets & (Buckets - 1)) == 0,
+                "bucket count must be a power of 2");
+
+ public:
+  using node_type = cache_node_t<Key>;
+
+ private:
+  enum : uint8_t { Q_NONE = 0, Q_PROBATION = 1, Q_PROTECTED = 2 };
+
+  counted_cdll_t<> probation;
+  counted_cdll_t<> protect;
+  uint64_t cap = 0;
+  uint64_t probation_max = 0;
+  [[no_unique_address]] Evict evict_fn{};
+  [[no_unique_address]] Hash hash_fn{};
+  node_type *buckets[Buckets] = {};
+
+  static node_type *node_of(cdlln_t<> *link) noexcept {
+    return reinterpret_cast<node_type *>(link);
+  }
+
+  node_type **bucket(const Key &key) noexcept {
+    return &buckets[hash_fn(key) & (Buckets - 1)];
+  }
+
+  void unhash(node_type *node) noexcept {
+    auto **itr = bucket(node->key);
+    while (*itr != node) {
+      itr = &(*itr)->hnext;
+    }
+    *itr = node->hnext;
+  }
+
+  void unqueue(node_type *node) noexcept {
+    if (node->queue == Q_PROBATION) {
+      probation.erase(node->link);
+    } else {
+      protect.erase(node->link);
+    }
+    node->queue = Q_NONE;
+  }
+
+  // evict one entry, caller ensures the cache is not empty
+  void evict_one() noexcept {
+    auto &queue = probation.size() >= probation_max || protect.empty()
+                      ? probation
+                      : protect;
+    auto *node = node_of(queue.back());
+    unqueue(node);
+    unhash(node);
+    evict_fn(static_cast<T *>(node));
+  }
+
+ public:
+  cache_t() noexcept = default;
+  cache_t(const cache_t &) = delete;
+  cache_t(cache_t &&) = delete;
+  cache_t &operator=(const cache_t &) = delete;
+  cache_t &operator=(cache_t &&) = delete;
+
+  /**
+   * @brief initialize an empty cache
+   * @param capacity max number of entries
+   * @param evict eviction callback
+   */
+  void init(uint64_t capacity, Evict evict = {}) noexcept {
+    probation.init();
+    protect.init();
+    cap = capacity;
+    probation_max = capacity / 4 > 0 ? capacity / 4 : 1;
+    evict_fn = std::move(evict);
+    for (auto &head : buckets) {
+      head = nullptr;
+    }
+  }
+
+  /**
+   * @brief look up key without touching recency
+   * @return entry, nullptr on miss
+   */
+  [[nodiscard]] T *peek(const Key &key) noexcept {
+    for (auto *node = *bucket(key); node != nullptr; node = node->hnext) {
+      if (node->key == key) {
+        return static_cast<T *>(node);
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief look up key and mark it recently used
+   * @return entry, nullptr on miss
+   */
+  T *find(const Key &key) noexcept {
+    auto *entry = peek(key);
+    if (entry != nullptr) [[likely]] {
+      touch(entry);
+    }
+    return entry;
+  }
+
+  /**
+   * @brief mark entry recently used, promotes probation entries
+   * @param entry cached entry
+   */
+  void touch(T *entry) noexcept {
+    node_type *node = entry;
+    if (node->queue == Q_PROBATION) {
+      probation.erase(node->link);
+      node->queue = Q_PROTECTED;
+      // keep protected within its share, demote its tail to probation
+      if (protect.size() >= cap - probation_max && !protect.empty()) {
+        auto *old = node_of(protect.pop_back());
+        old->queue = Q_PROBATION;
+        probation.push_front(old->link);
+      }
+    } else {
+      protect.erase(node->link);
+    }
+    protect.push_front(node->link);
+  }
+
+  /**
+   * @brief insert entry, evicts one entry if full
+   * @param entry entry not in any cache
+   * @param key key of entry
+   * @return false if key is already cached or capacity is 0, entry is not
+   * inserted
+   */
+  bool insert(T *entry, const Key &key) noexcept {
+    if (cap == 0 || peek(key) != nullptr) [[unlikely]] {
+      return false;
+    }
+    if (size() >= cap) {
+      evict_one();
+    }
+    node_type *node = entry;
+    node->key = key;
+    auto **head = bucket(key);
+    node->hnext = *head;
+    *head = node;
+    node->queue = Q_PROBATION;
+    probation.push_front(node->link);
+    return true;
+  }
+
+  /**
+   * @brief remove entry without calling the eviction callback
+   * @param entry cached entry
+   */
+  void erase(T *entry) noexcept {
+    node_type *node = entry;
+    unqueue(node);
+    unhash(node);
+  }
+
+  /**
+   * @brief evict every entry
+   */
+  void clear() noexcept {
+    while (size() != 0) {
+      evict_one();
+    }
+  }
+
+  [[nodiscard]] uint64_t size() const noexcept {
+    return probation.size() + protect.size();
+  }
+  [[nodiscard]] uint64_t capacity() const noexcept { return cap; }
+};
+
+/**
+ * @brief cache sharded by key hash, each shard has its own lock and lists
+ * @tparam Lock lock type with lock() and unlock()
+ * @tparam Shards shard count, power of 2
+ */
+template <typename T, typename Key, size_t Shards, size_t Buckets,
+          typename Lock, typename Evict = no_evict_t,
+          typename Hash = hash_t<Key>>
+class sharded_cache_t {
+  static_assert(Shards > 0 && (Shards & (Shards - 1)) == 0,
+                "shard count must be a power of 2");
+
+  // bucket index uses the low hash bits, shard index the high ones
+  struct CL_ALIGN shard_t {
+    Lock lock;
+    cache_t<T, Key, Buckets, Evict, Hash> cache;
+  };
+
+  shard_t shards[Shards];
+  [[no_unique_address]] Hash hash_fn{};
+
+  shard_t &shard(const Key &key) noexcept {
+    return shards[(hash_fn(key) >> 48U) & (Shards - 1)];
+  }
+
+ public:
+  /**
+   * @brief initialize all shards
+   * @param capacity max number of entries per shard
+   */
+  void init(uint64_t capacity, Evict evict = {}) noexcept {
+    for (auto &s : shards) {
+      s.cache.init(capacity, evict);
+    }
+  }
+
+  /**
+   * @brief look up key and call fn(T &) under the shard lock
+   * @return false on miss
+   */
+  template <typename Fn>
+  bool find(const Key &key, Fn &&fn) noexcept {
+    auto &s = shard(key);
+    s.lock.lock();
+    auto *entry = s.cache.find(key);
+    if (entry != nullptr) {
+      fn(*entry);
+    }
+    s.lock.unlock();
+    return entry != nullptr;
+  }
+
+  /**
+   * @brief insert entry, evicts from its shard if full, the eviction
+   * callback runs under the shard lock
+   * @return false if key is already cached
+   */
+  bool insert(T *entry, const Key &key) noexcept {
+    auto &s = shard(key);
+    s.lock.lock();
+    auto ret = s.cache.insert(entry, key);
+    s.lock.unlock();
+    return ret;
+  }
+
+  /**
+   * @brief remove entry without calling the eviction callback
+   */
+  void erase(T *entry) noexcept {
+    auto &s = shard(entry->cache_key());
+    s.lock.lock();
+    s.cache.erase(entry);
+    s.lock.unlock();
+  }
+};
+
+}  // namespace bsl
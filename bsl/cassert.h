@@ -2,6 +2,29 @@
 
 #include <config.h>
 
+/*
+Assertions
+A failing check passes one pointer to a static call site descriptor, kept
+out of the hot text in its own section, to an outlined cold handler, so
+the check itself is a compare and branch plus one address load, the
+descriptors land in the bsl_assert section, which the linker brackets with
+__start_bsl_assert / __stop_bsl_assert
+
+BSL_ASSERT_LEVEL selects what is compiled in
+  BSL_ASSERT_OFF   no assertions, expressions are not evaluated
+  BSL_ASSERT_CHEAP assert() only (default)
+  BSL_ASSERT_FULL  assert() and the expensive assert_full()
+panic, unreachable and todo are always on
+*/
+
+#define BSL_ASSERT_OFF 0
+#define BSL_ASSERT_CHEAP 1
+#define BSL_ASSERT_FULL 2
+
+#ifndef BSL_ASSERT_LEVEL
+#define BSL_ASSERT_LEVEL BSL_ASSERT_CHEAP
+#endif
+
 extern "C" {
 
 [[noreturn]] void _abort() noexcept;
@@ -10,27 +33,69 @@ void abort_msg(const char* msg, const char* file, unsigned line,
                const char* func) noexcept;
 }
 
-#define __assert_fail(msg, file, line, func) \
-  do {                                       \
-    abort_msg(msg, file, line, func);        \
-    _abort();                                \
+namespace bsl {
+
+// call site of a failure, one per check, never touched on the hot path
+struct assert_desc_t {
+  const char* msg;
+  const char* file;
+  const char* func;
+  unsigned line;
+};
+
+[[noreturn]] COLD NOINLINE inline void assert_fail(
+    const assert_desc_t* desc) noexcept {
+  abort_msg(desc->msg, desc->file, desc->line, desc->func);
+  _abort();
+}
+
+}  // namespace bsl
+
+#define BSL_ASSERT_DESC __attribute__((section("bsl_assert")))
+
+// the descriptor sits in a lambda, a static in the body itself would not
+// be allowed in constexpr functions, the function name is bound outside of
+// it since __PRETTY_FUNCTION__ in the lambda would name the lambda
+#define __assert_fail(msg)                                              \
+  do {                                                                  \
+    constexpr const char *__assert_fn = __PRETTY_FUNCTION__;            \
+    bsl::assert_fail([]() noexcept -> const bsl::assert_desc_t * {      \
+      static const bsl::assert_desc_t __assert_desc BSL_ASSERT_DESC = { \
+          msg, __FILE__, __assert_fn, __LINE__};                        \
+      return &__assert_desc;                                            \
+    }());                                                               \
   } while (0)
 
-#define assert(expr)                                                 \
-  do {                                                               \
-    if (!static_cast<bool>(expr)) [[unlikely]]                       \
-      __assert_fail(#expr, __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+#define __assert_check(expr)                   \
+  do {                                         \
+    if (!static_cast<bool>(expr)) [[unlikely]] \
+      __assert_fail(#expr);                    \
   } while (0)
 
+// type checks expr without evaluating it
+#define __assert_skip(expr)                \
+  do {                                     \
+    (void)sizeof(static_cast<bool>(expr)); \
+  } while (0)
+
+#if BSL_ASSERT_LEVEL >= BSL_ASSERT_CHEAP
+#define assert(expr) __assert_check(expr)
+#else
+#define assert(expr) __assert_skip(expr)
+#endif
+
+#if BSL_ASSERT_LEVEL >= BSL_ASSERT_FULL
+#define assert_full(expr) __assert_check(expr)
+#else
+#define assert_full(expr) __assert_skip(expr)
+#endif
+
 namespace bsl {
 
-#define panic(expr) \
-  __assert_fail("painc: " #expr, __FILE__, __LINE__, __PRETTY_FUNCTION__)
+#define panic(expr) __assert_fail("panic: " #expr)
 
-#define unreachable(expr) \
-  __assert_fail("unreachable: " #expr, __FILE__, __LINE__, __PRETTY_FUNCTION__)
+#define unreachable(expr) __assert_fail("unreachable: " #expr)
 
-#define todo(expr) \
-  __assert_fail("todo: " #expr, __FILE__, __LINE__, __PRETTY_FUNCTION__)
+#define todo(expr) __assert_fail("todo: " #expr)
 
 }  // namespace bsl
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <bsl/array.h>
+#include <bsl/simd.h>
+#include <bsl/string_view.h>
 #include <config.h>
 
+#include <bit>
+#include <type_traits>
+
 namespace bsl {
 
 INLINE constexpr bool islower(int ch) noexcept {
@@ -48,4 +54,120 @@ INLINE constexpr int to_digit(int ch) noexcept {
                                     : -1;
 }
 
-}  // namespace bsl
\ No newline at end of file
+// byte class bits, one table entry per byte value
+enum ctype_class : uint8_t {
+  CT_LOWER = 1U << 0U,
+  CT_UPPER = 1U << 1U,
+  CT_DIGIT = 1U << 2U,
+  CT_XDIGIT = 1U << 3U,
+  CT_PUNCT = 1U << 4U,
+  CT_SPACE = 1U << 5U,
+  CT_PRINT = 1U << 6U,
+};
+
+// byte class table, built from the predicates above
+inline constexpr array_t<uint8_t, 256> ctype_tbl = [] {
+  array_t<uint8_t, 256> tbl{};
+  for (int ch = 0; ch < 256; ++ch) {
+    tbl[ch] = (uint8_t)((islower(ch) ? CT_LOWER : 0) |
+                        (isupper(ch) ? CT_UPPER : 0) |
+                        (isdigit(ch) ? CT_DIGIT : 0) |
+                        (isxdigit(ch) ? CT_XDIGIT : 0) |
+                        (ispunct(ch) ? CT_PUNCT : 0) |
+                        (isspace(ch) ? CT_SPACE : 0) |
+                        (isprint(ch) ? CT_PRINT : 0));
+  }
+  return tbl;
+}();
+
+INLINE constexpr bool isclass(int ch, uint8_t cls) noexcept {
+  return (ctype_tbl[(uint8_t)ch] & cls) != 0;
+}
+
+// class kernels, written once for both scalar bytes and byte vectors
+// lo <= ch <= hi with a single unsigned compare
+template <typename T>
+FORCE_INLINE constexpr auto ct_range(T ch, uint8_t lo, uint8_t hi) noexcept {
+  return (T)(ch - lo) <= (uint8_t)(hi - lo);
+}
+
+template <uint8_t Cls, typename T>
+FORCE_INLINE constexpr auto ct_kernel(T ch) noexcept {
+  if constexpr (Cls == CT_SPACE) {
+    return ct_range(ch, '\t', '\r') | (ch == ' ');
+  } else if constexpr (Cls == CT_DIGIT) {
+    return ct_range(ch, '0', '9');
+  } else if constexpr (Cls == CT_XDIGIT) {
+    return ct_range(ch, '0', '9') | ct_range((T)(ch | 0x20), 'a', 'f');
+  } else if constexpr (Cls == CT_PRINT) {
+    return ct_range(ch, 0x20, 0x7e);
+  } else {
+    static_assert(Cls != Cls, "no vector kernel for class");
+  }
+}
+
+template <uint8_t Cls>
+constexpr bool ct_kernel_check() noexcept {
+  for (int ch = 0; ch < 256; ++ch) {
+    if ((bool)ct_kernel<Cls>((uint8_t)ch) != isclass(ch, Cls)) {
+      return false;
+    }
+  }
+  return true;
+}
+static_assert(ct_kernel_check<CT_SPACE>() && ct_kernel_check<CT_DIGIT>() &&
+                  ct_kernel_check<CT_XDIGIT>() && ct_kernel_check<CT_PRINT>(),
+              "vector kernels must match the byte class table");
+
+/**
+ * @brief classify SIMD_WIDTH bytes at once
+ * @param ptr source, at least SIMD_WIDTH bytes readable
+ * @return bit i set if ptr[i] is in class Cls
+ */
+template <uint8_t Cls>
+FORCE_INLINE uint32_t ctype_match(const char *ptr) noexcept {
+  return simd_mask((u8xw_t)ct_kernel<Cls>(simd_load<u8xw_t>(ptr)));
+}
+
+/**
+ * @brief length of the leading run of bytes in class Cls
+ * @param sv input
+ * @return index of the first byte not in Cls, sv.size() if none
+ */
+template <uint8_t Cls>
+FORCE_INLINE constexpr size_t span_class(sv_t sv) noexcept {
+  size_t pos = 0;
+  if (!std::is_constant_evaluated()) {
+    for (; pos + SIMD_WIDTH <= sv.size(); pos += SIMD_WIDTH) {
+      auto mask = ctype_match<Cls>(sv.data() + pos);
+      if (mask != SIMD_FULL_MASK<u8xw_t>) {
+        return pos + (size_t)std::countr_one(mask);
+      }
+    }
+  }
+  for (; pos < sv.size(); ++pos) {
+    if (!isclass(sv[pos], Cls)) {
+      return pos;
+    }
+  }
+  return pos;
+}
+
+// bulk classification
+INLINE constexpr size_t skip_space(sv_t sv) noexcept {
+  return span_class<CT_SPACE>(sv);
+}
+
+INLINE constexpr size_t span_digits(sv_t sv) noexcept {
+  return span_class<CT_DIGIT>(sv);
+}
+
+INLINE constexpr size_t span_xdigits(sv_t sv) noexcept {
+  return span_class<CT_XDIGIT>(sv);
+}
+
+INLINE constexpr bool all_print(sv_t sv) noexcept {
+  return span_class<CT_PRINT>(sv) == sv.size();
+}
+
+}  // namespace bsl
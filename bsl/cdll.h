@@ -16,6 +16,10 @@ the main difference is that cdll_t is not a container, since it doesn't owns the
 nodes, nodes need to be created and destroyed manually, or when using stack as
 underlying storage, push after lifetime starts, then pop before lifetime ends,
 or else it causes undefined behavior
+
+cdll_t<Tval, true> (counted_cdll_t) keeps an element count, so size() is O(1),
+the count is maintained by every list operation, nodes of a counted list must
+be removed through the list (erase), not by cdlln_t::unlink
 */
 
 #include <bsl/empty.h>
@@ -23,6 +27,7 @@ or else it causes undefined behavior
 #include <config.h>
 
 #include <concepts>
+#include <type_traits>
 #include <utility>
 
 namespace bsl {
@@ -31,7 +36,7 @@ namespace bsl {
 
 template <typename _Tval>
 class cdlln_t;
-template <typename _Tval>
+template <typename _Tval, bool _Counted>
 class cdll_t;
 template <typename _Tnode>
 class cdll_itr;
@@ -49,7 +54,7 @@ class cdlln_t {
   friend class cdll_itr;
   template <typename _Tnode>
   friend class cdll_ritr;
-  template <typename _Tval>
+  template <typename _Tval, bool _Counted>
   friend class cdll_t;
 
  public:
@@ -254,10 +259,14 @@ class cdll_ritr : public cdll_itr_base<cdll_ritr<Tnode>, Tnode> {
 };
 
 // circular doubly linked list
-template <typename Tval = empty_t>
+// Counted keeps an element count for O(1) size
+template <typename Tval = empty_t, bool Counted = false>
 class cdll_t {
+  template <typename _Tval, bool _Counted>
+  friend class cdll_t;
+
  public:
-  using type = cdll_t<Tval>;
+  using type = cdll_t<Tval, Counted>;
   using node_type = cdlln_t<Tval>;
   using empty_type = cdlln_t<empty_t>;
   using iterator = cdll_itr<node_type>;
@@ -267,13 +276,64 @@ class cdll_t {
   using value_type = Tval;
 
  private:
+  struct no_count_t {};
+  using count_type = std::conditional_t<Counted, uint64_t, no_count_t>;
+
   empty_type head;
+  [[no_unique_address]] count_type count{};
+
+  static empty_type *cast(node_type *node) noexcept {
+    return reinterpret_cast<empty_type *>(node);
+  }
+
+  void add_count([[maybe_unused]] uint64_t n) noexcept {
+    if constexpr (Counted) {
+      count += n;
+    }
+  }
+  void sub_count([[maybe_unused]] uint64_t n) noexcept {
+    if constexpr (Counted) {
+      count -= n;
+    }
+  }
+
+  // link the chain [first, last] before pos
+  static void link_before(empty_type *pos, empty_type *first,
+                          empty_type *last) noexcept {
+    first->prev = pos->prev;
+    last->next = pos;
+    pos->prev->next = first;
+    pos->prev = last;
+  }
+
+  // merge two sorted null terminated chains, stable, lhs holds the earlier
+  // elements
+  template <typename Cmp>
+  static empty_type *merge(empty_type *lhs, empty_type *rhs,
+                           Cmp &cmp) noexcept {
+    empty_type *ret = nullptr;
+    empty_type **tail = &ret;
+    while (lhs != nullptr && rhs != nullptr) {
+      if (cmp(*reinterpret_cast<const node_type *>(rhs),
+              *reinterpret_cast<const node_type *>(lhs))) {
+        *tail = rhs;
+        rhs = rhs->next;
+      } else {
+        *tail = lhs;
+        lhs = lhs->next;
+      }
+      tail = &(*tail)->next;
+    }
+    *tail = lhs != nullptr ? lhs : rhs;
+    return ret;
+  }
 
  public:
   cdll_t() noexcept = default;
   void init() noexcept {
     head.next = &head;
     head.prev = &head;
+    count = count_type{};
   }
   cdll_t(in_place_t) noexcept { init(); }
   cdll_t(const type &) = delete;
@@ -284,10 +344,13 @@ class cdll_t {
   [[nodiscard]] bool empty() const noexcept { return head.next == &head; }
 
   void push_back(node_type *node) &noexcept {
-    head.push_back(reinterpret_cast<empty_type *>(node));
+    head.push_back(cast(node));
+    add_count(1);
   }
   void push_back(node_type &node) &noexcept { push_back(&node); }
-  void push_back(void *node) &noexcept { head.push_back(node); }
+  void push_back(void *node) &noexcept {
+    push_back(reinterpret_cast<node_type *>(node));
+  }
   void push_back(type &list) &noexcept {
     if (list.empty()) {
       return;
@@ -296,6 +359,9 @@ class cdll_t {
     head.prev->next = list.head.next;
     head.prev = list.head.prev;
     list.head.prev->next = &head;
+    if constexpr (Counted) {
+      add_count(list.size());
+    }
     list.init();
   }
 
@@ -310,14 +376,18 @@ class cdll_t {
     empty_type *node = head.prev;
     head.prev = node->prev;
     head.prev->next = &head;
+    sub_count(1);
     return reinterpret_cast<node_type *>(node);
   }
 
   void push_front(node_type *node) &noexcept {
-    head.push_front(reinterpret_cast<empty_type *>(node));
+    head.push_front(cast(node));
+    add_count(1);
   }
   void push_front(node_type &node) &noexcept { push_front(&node); }
-  void push_front(void *node) &noexcept { head.push_front(node); }
+  void push_front(void *node) &noexcept {
+    push_front(reinterpret_cast<node_type *>(node));
+  }
   void push_front(type &list) &noexcept {
     if (list.empty()) {
       return;
@@ -326,6 +396,9 @@ class cdll_t {
     head.next->prev = list.head.prev;
     head.next = list.head.next;
     list.head.next->prev = &head;
+    if constexpr (Counted) {
+      add_count(list.size());
+    }
     list.init();
   }
 
@@ -340,9 +413,149 @@ class cdll_t {
     empty_type *node = head.next;
     head.next = node->next;
     head.next->prev = &head;
+    sub_count(1);
     return reinterpret_cast<node_type *>(node);
   }
 
+  /**
+   * @brief unlink node from this list
+   * @param node node in this list
+   * @return iterator to the node after it
+   */
+  iterator erase(node_type *node) &noexcept {
+    auto *next = cast(node)->next;
+    cast(node)->unlink();
+    sub_count(1);
+    return {reinterpret_cast<node_type *>(next)};
+  }
+  iterator erase(node_type &node) &noexcept { return erase(&node); }
+
+  /**
+   * @brief insert node before pos
+   * @param pos position in this list, end() to append
+   * @param node node to insert
+   */
+  void insert(iterator pos, node_type *node) &noexcept {
+    cast(pos)->push_back(cast(node));
+    add_count(1);
+  }
+
+  /**
+   * @brief move [first, last) of other before pos, O(1), O(n) on the range
+   * when a counted list moves nodes between lists
+   * @param pos position in this list
+   * @param other list owning the range, may be this list when pos is
+   * outside the range
+   * @param first first node to move
+   * @param last one past the last node to move
+   */
+  template <bool OCounted>
+  void splice(iterator pos, cdll_t<Tval, OCounted> &other, iterator first,
+              iterator last) &noexcept {
+    if (first == last) {
+      return;
+    }
+    if constexpr (Counted || OCounted) {
+      if ((void *)this != (void *)&other) {
+        uint64_t n = 0;
+        for (auto itr = first; itr != last; ++itr) {
+          ++n;
+        }
+        add_count(n);
+        other.sub_count(n);
+      }
+    }
+    auto *beg = cast(first);
+    auto *fin = cast(last)->prev;
+    // detach [beg, fin]
+    beg->prev->next = cast(last);
+    cast(last)->prev = beg->prev;
+    link_before(cast(pos), beg, fin);
+  }
+
+  /**
+   * @brief move one node of other before pos
+   */
+  template <bool OCounted>
+  void splice(iterator pos, cdll_t<Tval, OCounted> &other,
+              iterator itr) &noexcept {
+    auto next = itr;
+    ++next;
+    if (pos == itr || pos == next) {
+      return;
+    }
+    splice(pos, other, itr, next);
+  }
+
+  /**
+   * @brief move all nodes of other before pos
+   */
+  template <bool OCounted>
+  void splice(iterator pos, cdll_t<Tval, OCounted> &other) &noexcept {
+    if (other.empty()) {
+      return;
+    }
+    if constexpr (Counted) {
+      add_count(other.size());
+    }
+    link_before(cast(pos), other.head.next, other.head.prev);
+    other.init();
+  }
+
+  /**
+   * @brief stable bottom-up merge sort, relinks nodes, no allocation
+   * @param cmp strict weak order on nodes, cmp(const node_type &, const
+   * node_type &)
+   */
+  template <typename Cmp>
+  void sort(Cmp cmp) &noexcept {
+    if (head.next == head.prev) {
+      return;
+    }
+    // bins[i] is a sorted chain of 2^i nodes, higher bins hold earlier nodes
+    constexpr int max_bin = 64;
+    empty_type *bins[max_bin] = {};
+    head.prev->next = nullptr;
+    auto *itr = head.next;
+    while (itr != nullptr) {
+      auto *chain = itr;
+      itr = itr->next;
+      chain->next = nullptr;
+      int i = 0;
+      for (; i < max_bin - 1 && bins[i] != nullptr; ++i) {
+        chain = merge(bins[i], chain, cmp);
+        bins[i] = nullptr;
+      }
+      bins[i] = i == max_bin - 1 && bins[i] != nullptr
+                    ? merge(bins[i], chain, cmp)
+                    : chain;
+    }
+    empty_type *sorted = nullptr;
+    for (auto *bin : bins) {
+      if (bin != nullptr) {
+        sorted = merge(bin, sorted, cmp);
+      }
+    }
+    // restore prev links
+    auto *prev = &head;
+    for (; sorted != nullptr; sorted = sorted->next) {
+      sorted->prev = prev;
+      prev->next = sorted;
+      prev = sorted;
+    }
+    prev->next = &head;
+    head.prev = prev;
+  }
+
+  /**
+   * @brief sort by value, operator<
+   */
+  void sort() &noexcept {
+    sort([](const node_type &lhs, const node_type &rhs) {
+      return lhs.value() < rhs.value();
+    });
+  }
+
   [[nodiscard]] node_type *back() const noexcept {
     return reinterpret_cast<node_type *>(head.prev);
   }
@@ -400,16 +613,23 @@ class cdll_t {
   }
 
   /**
-   * @brief size of the list, O(n)
+   * @brief size of the list, O(1) when counted, O(n) otherwise
    * @return uint64_t
    */
   [[nodiscard]] uint64_t size() const noexcept {
-    uint64_t size = 0;
-    for ([[maybe_unused]] auto &itr : *this) {
-      ++size;
+    if constexpr (Counted) {
+      return count;
+    } else {
+      uint64_t size = 0;
+      for ([[maybe_unused]] auto &itr : *this) {
+        ++size;
+      }
+      return size;
     }
-    return size;
   }
 };
 
+template <typename Tval = empty_t>
+using counted_cdll_t = cdll_t<Tval, true>;
+
 }  // namespace bsl
@@ -2,6 +2,8 @@
 
 #include <bsl/string_view.h>
 
+#include <type_traits>
+
 namespace bsl {
 
 // CRTP extension for serial charachter device
@@ -32,7 +34,9 @@ class char_dev_t {
     return buf;
   }
 
+  // raw bytes of T, strings go through the string_view_t overload
   template <typename T, size_t sz = sizeof(T)>
+    requires(!std::is_convertible_v<T, bsl::string_view_t>)
   void write(const T data) {
     write((const char *)(&data), sz);
   }
@@ -19,8 +19,8 @@ NOINLINE size_t to_chars(char *buf, size_t buf_len, T val, int32_t base = 10) {
 }
 
 // template <typename T>
-NOINLINE size_t from_chars(const char *buf, size_t buf_len, uint64_t &val,
-                           int32_t base = 10) {
+INLINE NOINLINE size_t from_chars(const char *buf, size_t buf_len,
+                                  uint64_t &val, int32_t base = 10) {
   auto buf_itr = buf;
   auto buf_end = buf + buf_len;
   val = 0;
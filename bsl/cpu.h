@@ -0,0 +1,86 @@
+#pragma once
+
+#include <config.h>
+
+namespace bsl {
+
+// spin-wait hint, lets the sibling hyperthread run and saves power
+FORCE_INLINE void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#else
+  asm volatile("" ::: "memory");
+#endif
+}
+
+/**
+ * @brief read the free running cycle counter, ordered after earlier
+ * instructions, TSC on x86, virtual counter (cntvct_el0) on aarch64
+ * @return counter value, 0 where no counter is available
+ */
+FORCE_INLINE uint64_t rdcycle() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_lfence();
+  return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+  uint64_t val;
+  asm volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(val)::"memory");
+  return val;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief frequency of rdcycle() when the architecture reports it
+ * @return Hz, 0 if unknown (x86 TSC, calibrate against a wall clock)
+ */
+FORCE_INLINE uint64_t rdcycle_freq() noexcept {
+#if defined(__aarch64__)
+  uint64_t val;
+  asm volatile("mrs %0, cntfrq_el0" : "=r"(val));
+  return val;
+#else
+  return 0;
+#endif
+}
+
+// bounded exponential backoff, shared by the spinning primitives
+template <uint32_t Max = 1024>
+class backoff_t {
+  uint32_t spins = 1;
+
+ public:
+  /**
+   * @brief spin for the current delay, then double it up to Max
+   */
+  FORCE_INLINE void pause() noexcept {
+    for (uint32_t i = 0; i < spins; ++i) {
+      cpu_relax();
+    }
+    spins = spins < Max ? spins * 2 : Max;
+  }
+
+  /**
+   * @brief spin dist units of the current delay, e.g. the distance to the
+   * lock holder, the delay is left as is, the wait shrinks with dist
+   */
+  FORCE_INLINE void pause_for(uint32_t dist) noexcept {
+    for (uint64_t i = 0, n = (uint64_t)dist * spins; i < n; ++i) {
+      cpu_relax();
+    }
+  }
+
+  void reset() noexcept { spins = 1; }
+};
+
+// single relax per spin, for waiters on an uncontended line
+struct no_backoff_t {
+  FORCE_INLINE void pause() noexcept { cpu_relax(); }
+  FORCE_INLINE void pause_for(uint32_t) noexcept { cpu_relax(); }
+  void reset() noexcept {}
+};
+
+}  // namespace bsl
@@ -1,21 +1,115 @@
 #pragma once
 
+#include <bsl/array.h>
 #include <bsl/bswap.h>
 #include <config.h>
+
+#include <bit>
 #include <concepts>
 
 namespace bsl {
 
-// big endian types
+/**
+ * @brief load an integer stored in byte order E, no alignment requirement
+ * @param ptr source
+ */
+template <std::integral T, std::endian E>
+FORCE_INLINE T load_endian(const void *ptr) noexcept {
+  T val;
+  __builtin_memcpy(&val, ptr, sizeof(T));
+  if constexpr (E != std::endian::native) {
+    val = bswap(val);
+  }
+  return val;
+}
+
+/**
+ * @brief store an integer in byte order E, no alignment requirement
+ * @param ptr destination
+ * @param val value
+ */
+template <std::integral T, std::endian E>
+FORCE_INLINE void store_endian(void *ptr, T val) noexcept {
+  if constexpr (E != std::endian::native) {
+    val = bswap(val);
+  }
+  __builtin_memcpy(ptr, &val, sizeof(T));
+}
+
+template <std::integral T>
+FORCE_INLINE T load_be(const void *ptr) noexcept {
+  return load_endian<T, std::endian::big>(ptr);
+}
 template <std::integral T>
-class big_endian {
-  T value;
+FORCE_INLINE T load_le(const void *ptr) noexcept {
+  return load_endian<T, std::endian::little>(ptr);
+}
+template <std::integral T>
+FORCE_INLINE void store_be(void *ptr, T val) noexcept {
+  store_endian<T, std::endian::big>(ptr, val);
+}
+template <std::integral T>
+FORCE_INLINE void store_le(void *ptr, T val) noexcept {
+  store_endian<T, std::endian::little>(ptr, val);
+}
+
+// integer stored in byte order E
+// storage is a byte array, alignment is 1, so it is safe in PACKED structs
+// and over unaligned buffers, trivially copyable, reads and writes convert
+template <std::integral T, std::endian E>
+class PACKED endian_t {
+  array_t<uint8_t, sizeof(T)> bytes;
+
+  static constexpr T convert(T val) noexcept {
+    if constexpr (E != std::endian::native) {
+      return bswap(val);
+    } else {
+      return val;
+    }
+  }
 
  public:
-  constexpr big_endian(T value) noexcept : value(value) {}
-  inline constexpr operator T() const noexcept { return bswap(value); }
+  using value_type = T;
+
+  endian_t() noexcept = default;
+  constexpr endian_t(T value) noexcept
+      : bytes(std::bit_cast<array_t<uint8_t, sizeof(T)>>(convert(value))) {}
+
+  constexpr endian_t &operator=(T value) noexcept {
+    bytes = std::bit_cast<array_t<uint8_t, sizeof(T)>>(convert(value));
+    return *this;
+  }
+  inline constexpr operator T() const noexcept { return value(); }
+  [[nodiscard]] constexpr T value() const noexcept {
+    return convert(std::bit_cast<T>(bytes));
+  }
+  // value as stored, without conversion
+  [[nodiscard]] constexpr T raw() const noexcept {
+    return std::bit_cast<T>(bytes);
+  }
+
+  constexpr endian_t &operator+=(T rhs) noexcept {
+    return *this = (T)(value() + rhs);
+  }
+  constexpr endian_t &operator-=(T rhs) noexcept {
+    return *this = (T)(value() - rhs);
+  }
+  constexpr endian_t &operator&=(T rhs) noexcept {
+    return *this = (T)(value() & rhs);
+  }
+  constexpr endian_t &operator|=(T rhs) noexcept {
+    return *this = (T)(value() | rhs);
+  }
 };
 
+// big endian types
+template <std::integral T>
+using big_endian = endian_t<T, std::endian::big>;
+
+// little endian types
+template <std::integral T>
+using little_endian = endian_t<T, std::endian::little>;
+
 }  // namespace bsl
 
 using bu16_t = bsl::big_endian<uint16_t>;
@@ -23,4 +117,11 @@ using bu32_t = bsl::big_endian<uint32_t>;
 using bu64_t = bsl::big_endian<uint64_t>;
 using bi16_t = bsl::big_endian<int16_t>;
 using bi32_t = bsl::big_endian<int32_t>;
-using bi64_t = bsl::big_endian<int64_t>;
\ No newline at end of file
+using bi64_t = bsl::big_endian<int64_t>;
+
+using lu16_t = bsl::little_endian<uint16_t>;
+using lu32_t = bsl::little_endian<uint32_t>;
+using lu64_t = bsl::little_endian<uint64_t>;
+using li16_t = bsl::little_endian<int16_t>;
+using li32_t = bsl::little_endian<int32_t>;
+using li64_t = bsl::little_endian<int64_t>;
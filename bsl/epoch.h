@@ -0,0 +1,194 @@
+#pragma once
+
+/*
+Epoch Based Reclamation (QSBR flavour)
+Lock-free structures unlink nodes that other CPUs may still dereference,
+retire() defers the free until every online CPU has passed a quiescent
+state, a point where it holds no references into the structure (e.g.
+between requests, or on the way back to the scheduler)
+
+Read side critical sections cost nothing, a CPU only publishes the global
+epoch it has seen with one store and a full fence in quiescent(), a CPU
+going idle calls offline() so it does not hold back reclamation
+
+The global epoch advances once every online CPU has seen it, a node retired
+at epoch e is freed once the global epoch reaches e + 2, retired nodes wait
+on per-CPU intrusive lists and are freed in batches, the owner CPU is the
+only one touching its list
+
+Quiescent states are only ever announced by the caller, retire() and
+reclaim() may run inside a read side critical section, so they never report
+one themselves, a CPU that retires must still call quiescent() regularly
+for its nodes to be freed
+*/
+
+#include <bsl/cdll.h>
+#include <bsl/cpu.h>
+#include <config.h>
+
+#include <atomic>
+#include <utility>
+
+namespace bsl {
+
+// reclamation bookkeeping, embed by deriving from it
+class retire_node_t {
+  template <size_t MaxCpu, typename Free, uint64_t Batch>
+  friend class epoch_t;
+
+ private:
+  // must stay the first member, list nodes are cast back to retire_node_t
+  cdlln_t<> link;
+  uint64_t epoch = 0;
+
+ public:
+  retire_node_t() noexcept = default;
+  retire_node_t(const retire_node_t &) = delete;
+  retire_node_t(retire_node_t &&) = delete;
+  retire_node_t &operator=(const retire_node_t &) = delete;
+  retire_node_t &operator=(retire_node_t &&) = delete;
+};
+
+/**
+ * @brief epoch reclamation domain
+ * @tparam MaxCpu number of CPU records, CPU ids are [0, MaxCpu)
+ * @tparam Free free(retire_node_t *) releases a retired node
+ * @tparam Batch retired nodes per CPU before reclamation is attempted
+ */
+template <size_t MaxCpu, typename Free, uint64_t Batch = 64>
+class epoch_t {
+  static_assert(MaxCpu > 0, "need at least one CPU");
+
+  static constexpr uint64_t OFFLINE = ~0ULL;
+
+  struct CL_ALIGN record_t {
+    // last global epoch seen at a quiescent state, OFFLINE when idle
+    std::atomic<uint64_t> epoch{OFFLINE};
+    counted_cdll_t<> limbo{in_place};
+    // limbo size that triggers the next reclaim from retire()
+    uint64_t reclaim_at = Batch;
+  };
+
+  CL_ALIGN std::atomic<uint64_t> global{0};
+  [[no_unique_address]] Free free_fn{};
+  record_t records[MaxCpu];
+
+  static retire_node_t *node_of(cdlln_t<> *link) noexcept {
+    return reinterpret_cast<retire_node_t *>(link);
+  }
+
+  // advance the global epoch if every online CPU has seen it
+  uint64_t try_advance() noexcept {
+    auto cur = global.load(std::memory_order_acquire);
+    for (auto &rec : records) {
+      auto seen = rec.epoch.load(std::memory_order_acquire);
+      if (seen != OFFLINE && seen != cur) {
+        return cur;
+      }
+    }
+    if (global.compare_exchange_strong(cur, cur + 1,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+      return cur + 1;
+    }
+    return cur;
+  }
+
+ public:
+  epoch_t() noexcept = default;
+  explicit epoch_t(Free free) noexcept : free_fn(std::move(free)) {}
+  epoch_t(const epoch_t &) = delete;
+  epoch_t &operator=(const epoch_t &) = delete;
+
+  /**
+   * @brief start taking part in grace periods, call before touching shared
+   * structures
+   */
+  void online(size_t cpu) noexcept {
+    records[cpu].epoch.store(global.load(std::memory_order_acquire),
+                             std::memory_order_relaxed);
+    // the announcement must be visible before any shared pointer is read
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  /**
+   * @brief stop taking part in grace periods, cpu holds no references
+   */
+  void offline(size_t cpu) noexcept {
+    records[cpu].epoch.store(OFFLINE, std::memory_order_release);
+  }
+
+  /**
+   * @brief report a quiescent state, cpu holds no references
+   */
+  FORCE_INLINE void quiescent(size_t cpu) noexcept {
+    records[cpu].epoch.store(global.load(std::memory_order_acquire),
+                             std::memory_order_release);
+    // as in online(), the reads of the next critical section must not
+    // move ahead of the announcement
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  /**
+   * @brief defer the free of an unlinked node
+   * @param cpu current CPU
+   * @param node node no longer reachable by new readers
+   */
+  void retire(size_t cpu, retire_node_t *node) noexcept {
+    // order the unlink before sampling the epoch
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    node->epoch = global.load(std::memory_order_relaxed);
+    auto &rec = records[cpu];
+    rec.limbo.push_back(node->link);
+    if (rec.limbo.size() >= rec.reclaim_at) [[unlikely]] {
+      reclaim(cpu);
+      // nodes still in their grace period wait for another Batch retires
+      // instead of rescanning every record on each retire
+      rec.reclaim_at = rec.limbo.size() + Batch;
+    }
+  }
+
+  /**
+   * @brief free the nodes retired on cpu whose grace period has elapsed,
+   * does not report a quiescent state
+   * @return number of nodes freed
+   */
+  uint64_t reclaim(size_t cpu) noexcept {
+    auto cur = try_advance();
+    auto &limbo = records[cpu].limbo;
+    uint64_t freed = 0;
+    // retire order matches epoch order, stop at the first young node
+    while (!limbo.empty() && node_of(limbo.front())->epoch + 2 <= cur) {
+      free_fn(node_of(limbo.pop_front()));
+      ++freed;
+    }
+    return freed;
+  }
+
+  /**
+   * @brief wait for a grace period and free everything retired on cpu,
+   * cpu must not be inside a read side critical section
+   */
+  void drain(size_t cpu) noexcept {
+    backoff_t<> backoff;
+    auto &rec = records[cpu];
+    while (!rec.limbo.empty()) {
+      // an offline cpu already holds back nothing
+      if (rec.epoch.load(std::memory_order_relaxed) != OFFLINE) {
+        quiescent(cpu);
+      }
+      if (reclaim(cpu) == 0) {
+        backoff.pause();
+      }
+    }
+  }
+
+  [[nodiscard]] uint64_t pending(size_t cpu) const noexcept {
+    return records[cpu].limbo.size();
+  }
+  [[nodiscard]] uint64_t epoch() const noexcept {
+    return global.load(std::memory_order_relaxed);
+  }
+};
+
+}  // namespace bsl
@@ -0,0 +1,595 @@
+#pragma once
+
+/*
+Flattened Device Tree
+Zero-copy reader over a DTB blob, nothing is copied out of the blob, names
+and property values are returned as views into it, so the blob must outlive
+the reader
+
+Nodes are identified by the offset of their FDT_BEGIN_NODE token in the
+structure block, FDT_NPOS marks not found, lookups without an index rescan
+the structure block, fdt_index_t builds a one-pass index for O(1) path and
+phandle lookups
+*/
+
+#include <bsl/endian.h>
+#include <bsl/hash.h>
+#include <bsl/path.h>
+#include <bsl/span.h>
+#include <bsl/string_view.h>
+#include <config.h>
+
+#include <bit>
+
+namespace bsl {
+
+constexpr uint32_t FDT_MAGIC = 0xd00dfeed;
+constexpr uint32_t FDT_NPOS = 0xFFFFFFFF;
+// deepest node nesting walked by for_each_node
+constexpr uint32_t FDT_MAX_DEPTH = 64;
+
+enum fdt_tok : uint32_t {
+  FDT_BEGIN_NODE = 1,
+  FDT_END_NODE = 2,
+  FDT_PROP = 3,
+  FDT_NOP = 4,
+  FDT_END = 9,
+};
+
+struct fdt_header_t {
+  bu32_t magic;
+  bu32_t totalsize;
+  bu32_t off_dt_struct;
+  bu32_t off_dt_strings;
+  bu32_t off_mem_rsvmap;
+  bu32_t version;
+  bu32_t last_comp_version;
+  bu32_t boot_cpuid_phys;
+  bu32_t size_dt_strings;
+  bu32_t size_dt_struct;
+};
+
+// property view, name and value point into the blob
+struct fdt_prop_t {
+  sv_t name;
+  const char *data = nullptr;
+  uint32_t len = 0;
+
+  [[nodiscard]] bool valid() const noexcept { return data != nullptr; }
+
+  /**
+   * @brief value as string
+   * @return string without the terminating nul, empty if not a string
+   */
+  [[nodiscard]] sv_t str() const noexcept {
+    if (len == 0 || data[len - 1] != '\0') {
+      return {};
+    }
+    return {data, len - 1};
+  }
+
+  /**
+   * @brief value as array of big endian cells
+   */
+  [[nodiscard]] span_t<const bu32_t> cells() const noexcept {
+    return {reinterpret_cast<const bu32_t *>(data), len / 4};
+  }
+
+  /**
+   * @brief read a cell
+   * @param idx cell index
+   * @return cell value, 0 if out of range
+   */
+  [[nodiscard]] uint32_t u32(uint32_t idx = 0) const noexcept {
+    auto c = cells();
+    return idx < c.size() ? (uint32_t)c[idx] : 0;
+  }
+
+  /**
+   * @brief read a 64 bit value made of two cells
+   * @param idx index of the first cell
+   * @return value, 0 if out of range
+   */
+  [[nodiscard]] uint64_t u64(uint32_t idx = 0) const noexcept {
+    return ((uint64_t)u32(idx) << 32U) | u32(idx + 1);
+  }
+
+  /**
+   * @brief read a value of ncells cells, as used by reg and ranges
+   * @param idx index of the first cell
+   * @param ncells 1 or 2
+   */
+  [[nodiscard]] uint64_t cells_at(uint32_t idx, uint32_t ncells) const noexcept {
+    return ncells == 2 ? u64(idx) : u32(idx);
+  }
+};
+
+// flattened device tree reader
+class fdt_t {
+ private:
+  const char *blob = nullptr;
+  const char *strct = nullptr;
+  const char *strs = nullptr;
+  uint32_t strct_sz = 0;
+  uint32_t strs_sz = 0;
+
+  [[nodiscard]] uint32_t tok(uint32_t off) const noexcept {
+    return *reinterpret_cast<const bu32_t *>(strct + off);
+  }
+
+  static constexpr uint32_t align4(uint32_t val) noexcept {
+    return (val + 3U) & ~3U;
+  }
+
+ public:
+  fdt_t() noexcept = default;
+
+  /**
+   * @brief validate header and attach to blob
+   * @param dtb blob, 8 byte aligned
+   * @param size size of the buffer holding the blob, header totalsize is
+   * checked against it
+   * @return false if the header is invalid
+   */
+  bool init(const void *dtb, size_t size = UINT32_MAX) noexcept {
+    blob = nullptr;
+    const auto *hdr = reinterpret_cast<const fdt_header_t *>(dtb);
+    if (dtb == nullptr || size < sizeof(fdt_header_t) ||
+        hdr->magic != FDT_MAGIC) {
+      return false;
+    }
+    uint32_t total = hdr->totalsize;
+    uint32_t st_off = hdr->off_dt_struct;
+    uint32_t st_sz = hdr->size_dt_struct;
+    uint32_t sr_off = hdr->off_dt_strings;
+    uint32_t sr_sz = hdr->size_dt_strings;
+    // size_dt_struct is only present from version 17
+    if (total > size || hdr->version < 17 || hdr->last_comp_version > 17 ||
+        (st_off & 3U) != 0 || st_off > total || st_sz > total - st_off ||
+        sr_off > total || sr_sz > total - sr_off) {
+      return false;
+    }
+    blob = reinterpret_cast<const char *>(dtb);
+    strct = blob + st_off;
+    strs = blob + sr_off;
+    strct_sz = st_sz;
+    strs_sz = sr_sz;
+    return true;
+  }
+
+  [[nodiscard]] bool valid() const noexcept { return blob != nullptr; }
+  [[nodiscard]] const fdt_header_t &header() const noexcept {
+    return *reinterpret_cast<const fdt_header_t *>(blob);
+  }
+
+  /**
+   * @brief step over one token
+   * @param off offset of the token
+   * @param tag token tag
+   * @return offset of the next token, FDT_NPOS at FDT_END or on a truncated
+   * structure block
+   */
+  uint32_t next_tok(uint32_t off, uint32_t &tag) const noexcept {
+    if (strct_sz < 4 || off > strct_sz - 4) [[unlikely]] {
+      return FDT_NPOS;
+    }
+    tag = tok(off);
+    off += 4;
+    switch (tag) {
+      case FDT_BEGIN_NODE: {
+        const auto *nul = (const char *)bsl::memchr(strct + off, '\0',
+                                                    strct_sz - off);
+        if (nul == nullptr) [[unlikely]] {
+          return FDT_NPOS;
+        }
+        off += align4((uint32_t)(nul - (strct + off)) + 1);
+        break;
+      }
+      case FDT_PROP: {
+        // len is checked against the block before it moves off, so neither
+        // align4 nor the offset can wrap
+        if (strct_sz - off < 8) [[unlikely]] {
+          return FDT_NPOS;
+        }
+        auto len = tok(off);
+        if (len > strct_sz - off - 8) [[unlikely]] {
+          return FDT_NPOS;
+        }
+        off += 8 + align4(len);
+        break;
+      }
+      case FDT_END_NODE:
+      case FDT_NOP:
+        break;
+      default:
+        return FDT_NPOS;
+    }
+    return off <= strct_sz ? off : FDT_NPOS;
+  }
+
+  /**
+   * @brief root node
+   */
+  [[nodiscard]] uint32_t root() const noexcept {
+    uint32_t off = 0;
+    uint32_t tag = 0;
+    while (true) {
+      auto next = next_tok(off, tag);
+      if (next == FDT_NPOS) {
+        return FDT_NPOS;
+      }
+      if (tag == FDT_BEGIN_NODE) {
+        return off;
+      }
+      off = next;
+    }
+  }
+
+  /**
+   * @brief node name including the unit address, empty for root
+   */
+  [[nodiscard]] sv_t name(uint32_t node) const noexcept {
+    return sv_slow(strct + node + 4);
+  }
+
+  /**
+   * @brief first child of node
+   * @return child offset, FDT_NPOS if none
+   */
+  [[nodiscard]] uint32_t first_child(uint32_t node) const noexcept {
+    uint32_t tag = 0;
+    auto off = next_tok(node, tag);
+    while (off != FDT_NPOS) {
+      auto next = next_tok(off, tag);
+      if (next == FDT_NPOS || tag == FDT_END_NODE) {
+        return FDT_NPOS;
+      }
+      if (tag == FDT_BEGIN_NODE) {
+        return off;
+      }
+      off = next;
+    }
+    return FDT_NPOS;
+  }
+
+  /**
+   * @brief next sibling of node
+   * @return sibling offset, FDT_NPOS if none
+   */
+  [[nodiscard]] uint32_t next_sibling(uint32_t node) const noexcept {
+    uint32_t tag = 0;
+    uint32_t depth = 0;
+    auto off = node;
+    // skip over node and its subtree
+    do {
+      off = next_tok(off, tag);
+      if (off == FDT_NPOS) {
+        return FDT_NPOS;
+      }
+      if (tag == FDT_BEGIN_NODE) {
+        depth++;
+      } else if (tag == FDT_END_NODE) {
+        depth--;
+      }
+    } while (depth != 0);
+    while (true) {
+      auto next = next_tok(off, tag);
+      if (next == FDT_NPOS || tag == FDT_END_NODE) {
+        return FDT_NPOS;
+      }
+      if (tag == FDT_BEGIN_NODE) {
+        return off;
+      }
+      off = next;
+    }
+  }
+
+  /**
+   * @brief find child by name
+   * @param node parent
+   * @param child_name full name, or name without unit address to match the
+   * first child with that base name
+   * @return child offset, FDT_NPOS if not found
+   */
+  [[nodiscard]] uint32_t subnode(uint32_t node,
+                                 sv_t child_name) const noexcept {
+    bool no_unit = child_name.find('@') == sv_t::npos;
+    for (auto child = first_child(node); child != FDT_NPOS;
+         child = next_sibling(child)) {
+      auto cname = name(child);
+      if (cname == child_name) {
+        return child;
+      }
+      if (no_unit && cname.size() > child_name.size() &&
+          cname[child_name.size()] == '@' &&
+          cname.substr(0, child_name.size()) == child_name) {
+        return child;
+      }
+    }
+    return FDT_NPOS;
+  }
+
+  /**
+   * @brief find node by absolute path, e.g. /soc/uart@9000000
+   * @return node offset, FDT_NPOS if not found
+   */
+  [[nodiscard]] uint32_t find(sv_t path) const noexcept {
+    auto node = root();
+    while (node != FDT_NPOS && !path.empty()) {
+      auto [comp, rest] = lsplit_path(path);
+      if (!comp.empty()) {
+        node = subnode(node, comp);
+      }
+      path = rest;
+    }
+    return node;
+  }
+
+  /**
+   * @brief call fn(prop) for each property of node
+   * @param fn returns false to stop
+   */
+  template <typename Fn>
+  void for_each_prop(uint32_t node, Fn &&fn) const noexcept {
+    uint32_t tag = 0;
+    auto off = next_tok(node, tag);
+    while (off != FDT_NPOS) {
+      auto next = next_tok(off, tag);
+      if (next == FDT_NPOS) {
+        return;
+      }
+      if (tag == FDT_PROP) {
+        // next_tok checked that the value lies inside the structure block
+        // the name must end inside the strings block
+        uint32_t nameoff = tok(off + 8);
+        if (nameoff >= strs_sz) [[unlikely]] {
+          return;
+        }
+        const auto *nul = (const char *)bsl::memchr(strs + nameoff, '\0',
+                                                    strs_sz - nameoff);
+        if (nul == nullptr) [[unlikely]] {
+          return;
+        }
+        fdt_prop_t prop{sv_t(strs + nameoff, (size_t)(nul - (strs + nameoff))),
+                        strct + off + 12, tok(off + 4)};
+        if (!fn(prop)) {
+          return;
+        }
+      } else if (tag != FDT_NOP) {
+        return;
+      }
+      off = next;
+    }
+  }
+
+  /**
+   * @brief find property of node by name
+   * @return property, invalid if not found
+   */
+  [[nodiscard]] fdt_prop_t prop(uint32_t node, sv_t prop_name) const noexcept {
+    fdt_prop_t ret;
+    if (node == FDT_NPOS) {
+      return ret;
+    }
+    for_each_prop(node, [&](const fdt_prop_t &prop) {
+      if (prop.name == prop_name) {
+        ret = prop;
+        return false;
+      }
+      return true;
+    });
+    return ret;
+  }
+
+  /**
+   * @brief call fn(node, parent) for every node in document order
+   * @param fn returns false to stop
+   * @return false if the walk stopped at a node nested deeper than
+   * FDT_MAX_DEPTH
+   */
+  template <typename Fn>
+  bool for_each_node(Fn &&fn) const noexcept {
+    uint32_t stack[FDT_MAX_DEPTH];
+    uint32_t depth = 0;
+    uint32_t tag = 0;
+    uint32_t off = root();
+    while (off != FDT_NPOS) {
+      auto next = next_tok(off, tag);
+      if (next == FDT_NPOS) {
+        return true;
+      }
+      if (tag == FDT_BEGIN_NODE) {
+        if (depth == FDT_MAX_DEPTH) [[unlikely]] {
+          return false;
+        }
+        if (!fn(off, depth == 0 ? FDT_NPOS : stack[depth - 1])) {
+          return true;
+        }
+        stack[depth++] = off;
+      } else if (tag == FDT_END_NODE) {
+        if (--depth == 0) {
+          return true;
+        }
+      }
+      off = next;
+    }
+    return true;
+  }
+
+  /**
+   * @brief find node by phandle, scans the whole tree
+   * @return node offset, FDT_NPOS if not found
+   */
+  [[nodiscard]] uint32_t by_phandle(uint32_t phandle) const noexcept {
+    uint32_t ret = FDT_NPOS;
+    for_each_node([&](uint32_t node, uint32_t) {
+      if (phandle_of(node) == phandle) {
+        ret = node;
+        return false;
+      }
+      return true;
+    });
+    return ret;
+  }
+
+  /**
+   * @brief phandle of node
+   * @return phandle, 0 if none
+   */
+  [[nodiscard]] uint32_t phandle_of(uint32_t node) const noexcept {
+    auto ph = prop(node, "phandle");
+    return ph.valid() ? ph.u32() : prop(node, "linux,phandle").u32();
+  }
+};
+
+// one-pass index over an fdt_t, node offsets by path hash and by phandle
+// MaxNodes bounds the node count, build fails on larger trees
+template <size_t MaxNodes>
+class fdt_index_t {
+  static constexpr size_t cap = std::bit_ceil(MaxNodes * 2);
+
+  struct path_ent_t {
+    uint64_t hash = 0;
+    uint32_t node = FDT_NPOS;
+  };
+  struct ph_ent_t {
+    uint32_t phandle = 0;
+    uint32_t node = FDT_NPOS;
+  };
+
+  const fdt_t *fdt = nullptr;
+  path_ent_t paths[cap];
+  ph_ent_t phandles[cap];
+  // path hash of each node on the walk stack
+  uint64_t hash_stack[FDT_MAX_DEPTH];
+  uint32_t node_stack[FDT_MAX_DEPTH];
+
+  static constexpr uint64_t root_seed = 0x2f;
+
+  bool insert_path(uint64_t hash, uint32_t node) noexcept {
+    for (size_t i = 0, idx = hash & (cap - 1); i < cap;
+         ++i, idx = (idx + 1) & (cap - 1)) {
+      if (paths[idx].node == FDT_NPOS) {
+        paths[idx] = {hash, node};
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool insert_phandle(uint32_t phandle, uint32_t node) noexcept {
+    for (size_t i = 0, idx = hash64(phandle) & (cap - 1); i < cap;
+         ++i, idx = (idx + 1) & (cap - 1)) {
+      if (phandles[idx].node == FDT_NPOS) {
+        phandles[idx] = {phandle, node};
+        return true;
+      }
+    }
+    return false;
+  }
+
+ public:
+  fdt_index_t() noexcept = default;
+  fdt_index_t(const fdt_index_t &) = delete;
+  fdt_index_t &operator=(const fdt_index_t &) = delete;
+
+  /**
+   * @brief index every node of fdt in one walk
+   * @return false if the tree has more than MaxNodes nodes or is deeper
+   * than FDT_MAX_DEPTH levels
+   */
+  bool build(const fdt_t &tree) noexcept {
+    fdt = &tree;
+    for (auto &ent : paths) {
+      ent = {};
+    }
+    for (auto &ent : phandles) {
+      ent = {};
+    }
+    size_t count = 0;
+    uint32_t depth = 0;
+    bool ok = true;
+    // a deeper tree stops the walk, which bounds the stacks
+    bool whole = tree.for_each_node([&](uint32_t node, uint32_t parent) {
+      if (++count > MaxNodes) {
+        ok = false;
+        return false;
+      }
+      // unwind stack to the parent
+      while (depth > 0 && node_stack[depth - 1] != parent) {
+        depth--;
+      }
+      auto hash = parent == FDT_NPOS
+                      ? root_seed
+                      : hash_sv(tree.name(node), hash_stack[depth - 1]);
+      hash_stack[depth] = hash;
+      node_stack[depth] = node;
+      depth++;
+      insert_path(hash, node);
+      if (auto ph = tree.phandle_of(node); ph != 0) {
+        insert_phandle(ph, node);
+      }
+      return true;
+    });
+    ok = ok && whole;
+    if (!ok) {
+      fdt = nullptr;
+    }
+    return ok;
+  }
+
+  /**
+   * @brief find node by absolute path, names must include unit addresses,
+   * paths that don't fall back to fdt_t::find
+   * @return node offset, FDT_NPOS if not found or not built
+   */
+  [[nodiscard]] uint32_t find(sv_t path) const noexcept {
+    if (fdt == nullptr) [[unlikely]] {
+      return FDT_NPOS;
+    }
+    uint64_t hash = root_seed;
+    sv_t last;
+    for (auto rest = path; !rest.empty();) {
+      auto [comp, next] = lsplit_path(rest);
+      if (!comp.empty()) {
+        hash = hash_sv(comp, hash);
+        last = comp;
+      }
+      rest = next;
+    }
+    for (size_t i = 0, idx = hash & (cap - 1); i < cap;
+         ++i, idx = (idx + 1) & (cap - 1)) {
+      const auto &ent = paths[idx];
+      if (ent.node == FDT_NPOS) {
+        break;
+      }
+      if (ent.hash == hash && fdt->name(ent.node) == last) {
+        return ent.node;
+      }
+    }
+    return fdt->find(path);
+  }
+
+  /**
+   * @brief find node by phandle
+   * @return node offset, FDT_NPOS if not found or not built
+   */
+  [[nodiscard]] uint32_t by_phandle(uint32_t phandle) const noexcept {
+    if (fdt == nullptr) [[unlikely]] {
+      return FDT_NPOS;
+    }
+    for (size_t i = 0, idx = hash64(phandle) & (cap - 1); i < cap;
+         ++i, idx = (idx + 1) & (cap - 1)) {
+      const auto &ent = phandles[idx];
+      if (ent.node == FDT_NPOS) {
+        break;
+      }
+      if (ent.phandle == phandle) {
+        return ent.node;
+      }
+    }
+    return FDT_NPOS;
+  }
+};
+
+}  // namespace bsl
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <bsl/string_view.h>
 #include <config.h>
 
+#include <concepts>
+#include <type_traits>
+
 namespace bsl {
 
 // unsigned long rndr() {
@@ -26,4 +30,37 @@ constexpr uint8_t hash8(uint64_t val) {
     return arr[0] ^ arr[1] ^ arr[2] ^ arr[3];
 }
 
+// string hash, bytes are packed into words and mixed by multiply-xorshift
+// chainable, hash_sv(b, hash_sv(a)) hashes the sequence (a, b)
+constexpr uint64_t hash_sv(sv_t sv, uint64_t seed = 0) {
+  constexpr uint64_t mul = 0x9e3779b97f4a7c15;
+  uint64_t hash = seed ^ sv.size();
+  uint64_t word = 0;
+  for (size_t i = 0; i < sv.size(); ++i) {
+    word |= (uint64_t)(uint8_t)sv[i] << ((i % 8) * 8);
+    if (i % 8 == 7) {
+      hash = (hash ^ word) * mul;
+      hash ^= hash >> 32;
+      word = 0;
+    }
+  }
+  hash = (hash ^ word) * mul;
+  return hash64(hash ^ (hash >> 32));
+}
+
+// default hash functor for keys of bsl containers
+template <typename Key>
+struct hash_t {
+  constexpr uint64_t operator()(const Key &key) const noexcept {
+    if constexpr (std::is_convertible_v<const Key &, sv_t>) {
+      return hash_sv(key);
+    } else {
+      static_assert(std::integral<Key> || std::is_enum_v<Key> ||
+                        std::is_pointer_v<Key>,
+                    "no default hash for key type");
+      return hash64((uint64_t)key);
+    }
+  }
+};
+
 }  // namespace bsl
\ No newline at end of file
@@ -0,0 +1,217 @@
+#pragma once
+
+/*
+Latency Histogram
+HDR style log-linear buckets in a fixed array, every power of 2 range is
+split into 2^SubBits linear sub-buckets, so the relative error of any
+reported value is below 2^-SubBits while the whole uint64_t range takes
+(Bits - SubBits + 1) << SubBits counters (976 for the defaults)
+
+Recording clamps the value to the tracked range and bumps one counter,
+percentiles walk the buckets and report the highest value equivalent to the
+bucket holding the requested rank
+
+percpu_histogram_t records on the current CPU's histogram with relaxed
+loads and stores, no atomic read-modify-write, and merges every CPU's
+counts on read
+*/
+
+#include <bsl/char_dev.h>
+#include <bsl/charconv.h>
+#include <bsl/cmath.h>
+#include <bsl/percpu.h>
+#include <config.h>
+
+#include <atomic>
+#include <utility>
+
+namespace bsl {
+
+/**
+ * @brief log-linear histogram
+ * @tparam SubBits log2 of the sub-buckets per power of 2, precision
+ * @tparam Bits values above 2^Bits - 1 are clamped
+ */
+template <unsigned SubBits = 4, unsigned Bits = 64>
+class histogram_t {
+  static_assert(SubBits > 0 && SubBits < Bits && Bits <= 64,
+                "bad histogram precision");
+
+  static constexpr uint64_t SUB = 1ULL << SubBits;
+  static constexpr uint64_t MAX_VAL =
+      Bits == 64 ? ~0ULL : (1ULL << Bits) - 1;
+
+ public:
+  static constexpr size_t BUCKETS = (size_t)(Bits - SubBits + 1) << SubBits;
+
+ private:
+  uint64_t counts[BUCKETS] = {};
+  uint64_t total = 0;
+  uint64_t sum = 0;
+
+ public:
+  // bucket holding val, val is already clamped
+  static constexpr size_t bucket(uint64_t val) noexcept {
+    auto shift = (unsigned)log2_floor(val | SUB) - SubBits;
+    return ((size_t)shift << SubBits) + (size_t)(val >> shift);
+  }
+  // smallest value in bucket idx
+  static constexpr uint64_t lowest(size_t idx) noexcept {
+    auto high = idx >> SubBits;
+    if (high <= 1) {
+      return idx;
+    }
+    return ((idx & (SUB - 1)) | SUB) << (high - 1);
+  }
+  // largest value in bucket idx
+  static constexpr uint64_t highest(size_t idx) noexcept {
+    auto high = idx >> SubBits;
+    return lowest(idx) + (high <= 1 ? 0 : (1ULL << (high - 1)) - 1);
+  }
+
+  FORCE_INLINE void record(uint64_t val, uint64_t n = 1) noexcept {
+    val = val < MAX_VAL ? val : MAX_VAL;
+    counts[bucket(val)] += n;
+    total += n;
+    sum += val * n;
+  }
+
+  /**
+   * @brief record with relaxed atomic stores, one writer, readers may merge
+   * concurrently
+   */
+  FORCE_INLINE void record_shared(uint64_t val, uint64_t n = 1) noexcept {
+    val = val < MAX_VAL ? val : MAX_VAL;
+    auto bump = [](uint64_t &cnt, uint64_t inc) {
+      std::atomic_ref ref(cnt);
+      ref.store(ref.load(std::memory_order_relaxed) + inc,
+                std::memory_order_relaxed);
+    };
+    bump(counts[bucket(val)], n);
+    bump(total, n);
+    bump(sum, val * n);
+  }
+
+  // add other's counts, other may be updated by record_shared meanwhile
+  void merge(const histogram_t &other) noexcept {
+    auto load = [](const uint64_t &cnt) {
+      return std::atomic_ref(const_cast<uint64_t &>(cnt))
+          .load(std::memory_order_relaxed);
+    };
+    uint64_t merged = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      auto cnt = load(other.counts[i]);
+      counts[i] += cnt;
+      merged += cnt;
+    }
+    // keep total consistent with the counts actually merged
+    total += merged;
+    sum += load(other.sum);
+  }
+
+  void reset() noexcept {
+    for (auto &cnt : counts) {
+      cnt = 0;
+    }
+    total = 0;
+    sum = 0;
+  }
+
+  [[nodiscard]] uint64_t count() const noexcept { return total; }
+  [[nodiscard]] uint64_t mean() const noexcept {
+    return total != 0 ? sum / total : 0;
+  }
+
+  /**
+   * @brief value at quantile num / den, e.g. (99, 100) or (999, 1000)
+   * @return highest value equivalent to the bucket holding that rank, 0 if
+   * empty
+   */
+  [[nodiscard]] uint64_t value_at(uint64_t num, uint64_t den) const noexcept {
+    if (total == 0 || den == 0) {
+      return 0;
+    }
+    auto rank = (uint64_t)(((uint128_t)total * num + den - 1) / den);
+    rank = rank > 0 ? rank : 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return highest(i);
+      }
+    }
+    return MAX_VAL;
+  }
+  [[nodiscard]] uint64_t max() const noexcept { return value_at(1, 1); }
+
+  /**
+   * @brief one summary line, count, mean, p50, p90, p99, p999, max
+   */
+  template <typename Dev>
+  void print(char_dev_t<Dev> &dev, sv_t name) const noexcept {
+    auto field = [&](sv_t key, uint64_t val) {
+      char buf[24];
+      dev.write(key);
+      dev.write(buf, to_chars(buf, sizeof(buf), val));
+    };
+    dev.write(name);
+    field(" count=", total);
+    field(" mean=", mean());
+    field(" p50=", value_at(50, 100));
+    field(" p90=", value_at(90, 100));
+    field(" p99=", value_at(99, 100));
+    field(" p999=", value_at(999, 1000));
+    field(" max=", max());
+    dev.write("\n");
+  }
+
+  /**
+   * @brief every non-empty bucket as "lowest highest count" lines, enough
+   * to rebuild the histogram offline
+   */
+  template <typename Dev>
+  void dump(char_dev_t<Dev> &dev) const noexcept {
+    char buf[24];
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      if (counts[i] == 0) {
+        continue;
+      }
+      dev.write(buf, to_chars(buf, sizeof(buf), lowest(i)));
+      dev.write(" ");
+      dev.write(buf, to_chars(buf, sizeof(buf), highest(i)));
+      dev.write(" ");
+      dev.write(buf, to_chars(buf, sizeof(buf), counts[i]));
+      dev.write("\n");
+    }
+  }
+};
+
+// per-CPU recording, merged on read
+template <size_t MaxCpu, cpu_id_hook CpuId, unsigned SubBits = 4,
+          unsigned Bits = 64>
+class percpu_histogram_t {
+  using hist_type = histogram_t<SubBits, Bits>;
+
+  percpu_t<hist_type, MaxCpu, CpuId> hists;
+
+ public:
+  percpu_histogram_t() noexcept = default;
+  explicit percpu_histogram_t(CpuId hook) noexcept : hists(std::move(hook)) {}
+
+  // record on the current CPU, must not migrate during the call
+  FORCE_INLINE void record(uint64_t val, uint64_t n = 1) noexcept {
+    hists.local().record_shared(val, n);
+  }
+
+  // sum of every CPU, not a snapshot while recording is in flight
+  void merge_into(hist_type &out) const noexcept {
+    hists.for_each([&](const hist_type &hist) { out.merge(hist); });
+  }
+  [[nodiscard]] hist_type merged() const noexcept {
+    hist_type ret;
+    merge_into(ret);
+    return ret;
+  }
+};
+
+}  // namespace bsl
@@ -0,0 +1,193 @@
+#pragma once
+
+/*
+Binary Layout
+Declarative zero-copy access to packet and on-disk formats, a layout is a
+struct declaring its fixed size and one type per field
+
+struct udp_hdr {
+  static constexpr size_t size = 8;
+  using sport = bsl::be_field<uint16_t, 0>;
+  using dport = bsl::be_field<uint16_t, 2>;
+  using len = bsl::be_field<uint16_t, 4>;
+  using csum = bsl::be_field<uint16_t, 6>;
+};
+
+bin_view_t<udp_hdr> checks the buffer length once on creation, every
+accessor then compiles to a single unaligned load (plus bswap), fields are
+checked against the layout size at compile time, bin_mut_view_t adds
+in-place writes
+*/
+
+#include <bsl/endian.h>
+#include <bsl/span.h>
+#include <config.h>
+
+#include <bit>
+#include <concepts>
+#include <type_traits>
+
+namespace bsl {
+
+/**
+ * @brief integer field
+ * @tparam T storage type, read and written as a whole
+ * @tparam Off byte offset in the layout
+ * @tparam E byte order
+ * @tparam Shift bit offset of the field inside T, for sub-word fields
+ * @tparam Bits field width in bits
+ */
+template <std::integral T, size_t Off, std::endian E, unsigned Shift = 0,
+          unsigned Bits = sizeof(T) * 8>
+struct field_t {
+  static_assert(Bits > 0 && Shift + Bits <= sizeof(T) * 8,
+                "field bits out of storage");
+  using value_type = T;
+  static constexpr size_t offset = Off;
+  static constexpr size_t width = sizeof(T);
+  static constexpr bool whole = Shift == 0 && Bits == sizeof(T) * 8;
+  static constexpr T mask =
+      Bits == sizeof(T) * 8 ? (T)~(T)0 : (T)((((T)1 << Bits) - 1) << Shift);
+
+  static FORCE_INLINE T load(const uint8_t *base) noexcept {
+    auto raw = load_endian<T, E>(base + Off);
+    if constexpr (whole) {
+      return raw;
+    } else {
+      return (T)((raw & mask) >> Shift);
+    }
+  }
+  static FORCE_INLINE void store(uint8_t *base, T val) noexcept {
+    if constexpr (whole) {
+      store_endian<T, E>(base + Off, val);
+    } else {
+      auto raw = load_endian<T, E>(base + Off);
+      raw = (T)((raw & ~mask) | (((T)(val << Shift)) & mask));
+      store_endian<T, E>(base + Off, raw);
+    }
+  }
+};
+
+template <std::integral T, size_t Off, unsigned Shift = 0,
+          unsigned Bits = sizeof(T) * 8>
+using be_field = field_t<T, Off, std::endian::big, Shift, Bits>;
+
+template <std::integral T, size_t Off, unsigned Shift = 0,
+          unsigned Bits = sizeof(T) * 8>
+using le_field = field_t<T, Off, std::endian::little, Shift, Bits>;
+
+// raw byte array field, e.g. addresses
+template <size_t Off, size_t Len>
+struct bytes_field_t {
+  static constexpr size_t offset = Off;
+  static constexpr size_t width = Len;
+};
+
+template <typename L>
+concept bin_layout = requires {
+  { L::size } -> std::convertible_to<size_t>;
+};
+
+template <typename F, typename L>
+concept bin_field_of = (F::offset + F::width <= L::size);
+
+// read-only view over a buffer holding layout L
+template <bin_layout L>
+class bin_view_t {
+ protected:
+  const uint8_t *base = nullptr;
+  size_t len = 0;
+
+  bin_view_t(const uint8_t *base, size_t len) noexcept
+      : base(base), len(len) {}
+
+ public:
+  using layout_type = L;
+
+  bin_view_t() noexcept = default;
+
+  /**
+   * @brief create view, the only bounds check
+   * @param buf buffer, no alignment requirement
+   * @param buf_len buffer length
+   * @return view, invalid if buf_len < L::size
+   */
+  static bin_view_t make(const void *buf, size_t buf_len) noexcept {
+    if (buf == nullptr || buf_len < L::size) [[unlikely]] {
+      return {};
+    }
+    return {reinterpret_cast<const uint8_t *>(buf), buf_len};
+  }
+  static bin_view_t make(span_t<const uint8_t> buf) noexcept {
+    return make(buf.data(), buf.size());
+  }
+
+  [[nodiscard]] bool valid() const noexcept { return base != nullptr; }
+
+  template <typename F>
+    requires bin_field_of<F, L>
+  [[nodiscard]] FORCE_INLINE auto get() const noexcept {
+    if constexpr (requires { typename F::value_type; }) {
+      return F::load(base);
+    } else {
+      return span_t<const uint8_t, F::width>(base + F::offset, F::width);
+    }
+  }
+
+  // bytes past the fixed part, e.g. payload or options
+  [[nodiscard]] span_t<const uint8_t> tail() const noexcept {
+    return {base + L::size, len - L::size};
+  }
+  [[nodiscard]] span_t<const uint8_t> bytes() const noexcept {
+    return {base, len};
+  }
+};
+
+// read-write view over a buffer holding layout L
+template <bin_layout L>
+class bin_mut_view_t : public bin_view_t<L> {
+  using base_type = bin_view_t<L>;
+
+  bin_mut_view_t(uint8_t *base, size_t len) noexcept : base_type(base, len) {}
+  uint8_t *mut_base() const noexcept {
+    return const_cast<uint8_t *>(base_type::base);
+  }
+
+ public:
+  bin_mut_view_t() noexcept = default;
+
+  /**
+   * @brief create view, the only bounds check
+   * @param buf buffer, no alignment requirement
+   * @param buf_len buffer length
+   * @return view, invalid if buf_len < L::size
+   */
+  static bin_mut_view_t make(void *buf, size_t buf_len) noexcept {
+    if (buf == nullptr || buf_len < L::size) [[unlikely]] {
+      return {};
+    }
+    return {reinterpret_cast<uint8_t *>(buf), buf_len};
+  }
+  static bin_mut_view_t make(span_t<uint8_t> buf) noexcept {
+    return make(buf.data(), buf.size());
+  }
+
+  template <typename F>
+    requires bin_field_of<F, L> && requires { typename F::value_type; }
+  FORCE_INLINE void set(typename F::value_type val) const noexcept {
+    F::store(mut_base(), val);
+  }
+
+  template <typename F>
+    requires bin_field_of<F, L> && (!requires { typename F::value_type; })
+  [[nodiscard]] FORCE_INLINE span_t<uint8_t, F::width> mut_bytes()
+      const noexcept {
+    return span_t<uint8_t, F::width>(mut_base() + F::offset, F::width);
+  }
+
+  [[nodiscard]] span_t<uint8_t> mut_tail() const noexcept {
+    return {mut_base() + L::size, base_type::len - L::size};
+  }
+};
+
+}  // namespace bsl
@@ -7,7 +7,7 @@
 #include <atomic>
 #include <utility>
 
-// thread safe
+// thread safe, multi producer push, single consumer pop
 
 namespace bsl {
 
@@ -75,6 +75,7 @@ class ll_itr {
   }
   type &operator++() noexcept {
     node = node->next.load(std::memory_order_relaxed);
+    return *this;
   }
   type operator++(int) &noexcept {
     type tmp(*this);
@@ -131,7 +132,7 @@ class ll_t {
     auto *node_cast = reinterpret_cast<empty_type *>(node);
     auto *old = head.next.load(std::memory_order_relaxed);
     while (true) {
-      node->next.store(old, std::memory_order_relaxed);
+      node_cast->next.store(old, std::memory_order_relaxed);
       if (head.next.compare_exchange_weak(old, node_cast,
                                           std::memory_order_release,
                                           std::memory_order_relaxed)) {
@@ -142,13 +143,24 @@ class ll_t {
   void push(node_type &node) &noexcept { push(&node); }
   void push(void *node) &noexcept { push(reinterpret_cast<node_type *>(node)); }
 
+  /**
+   * @brief pop the most recently pushed node
+   * @note pushes may run from any number of threads, pops from one thread
+   * at a time, concurrent pops could see a popped and re-pushed node (ABA)
+   * @return node_type* pointer to node, PTR_FAIL if list is empty
+   */
   node_type *pop() &noexcept {
-    auto *old = head.next.load(std::memory_order_relaxed);
+    auto *old = head.next.load(std::memory_order_acquire);
     while (true) {
       if (old == (empty_type *)PTR_FAIL) {
-        return PTR_FAIL;
+        return (node_type *)PTR_FAIL;
       }
       auto *next = old->next.load(std::memory_order_relaxed);
+      if (head.next.compare_exchange_weak(old, next,
+                                          std::memory_order_acquire,
+                                          std::memory_order_acquire)) {
+        return reinterpret_cast<node_type *>(old);
+      }
     }
   }
 };
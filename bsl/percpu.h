@@ -0,0 +1,121 @@
+#pragma once
+
+/*
+Per-CPU Data
+percpu_t<T> keeps one instance of T per CPU, each on its own cache line,
+so CPUs updating their own instance never share a line, the current CPU
+comes from a caller supplied hook, e.g. a read of tpidr_el1 / gs base in a
+kernel, or sched_getcpu() when hosted
+
+sharded_counter_t spreads a counter over per-CPU slots, increments are
+relaxed and hit only the local line, reads sum every slot and are not a
+snapshot while increments are in flight
+*/
+
+#include <config.h>
+
+#include <atomic>
+#include <concepts>
+#include <utility>
+
+namespace bsl {
+
+template <typename F>
+concept cpu_id_hook = requires(const F &fn) {
+  { fn() } noexcept -> std::convertible_to<size_t>;
+};
+
+/**
+ * @brief one T per CPU
+ * @tparam MaxCpu number of slots, CPU ids are [0, MaxCpu)
+ * @tparam CpuId hook returning the current CPU id
+ */
+template <typename T, size_t MaxCpu, cpu_id_hook CpuId>
+class percpu_t {
+  static_assert(MaxCpu > 0, "need at least one CPU");
+
+  struct CL_ALIGN slot_t {
+    T val{};
+  };
+
+  slot_t slots[MaxCpu];
+  [[no_unique_address]] CpuId cpu_id{};
+
+ public:
+  percpu_t() noexcept = default;
+  explicit percpu_t(CpuId hook) noexcept : cpu_id(std::move(hook)) {}
+  percpu_t(const percpu_t &) = delete;
+  percpu_t &operator=(const percpu_t &) = delete;
+
+  /**
+   * @brief instance of the current CPU, caller must not migrate while
+   * using it unless T is safe to update remotely, traps if the hook returns
+   * an id outside [0, MaxCpu) (e.g. sched_getcpu() failing with -1)
+   */
+  [[nodiscard]] FORCE_INLINE T &local() noexcept {
+    auto cpu = (size_t)cpu_id();
+    if (cpu >= MaxCpu) [[unlikely]] {
+      __builtin_trap();
+    }
+    return slots[cpu].val;
+  }
+  [[nodiscard]] T &operator[](size_t cpu) noexcept { return slots[cpu].val; }
+  [[nodiscard]] const T &operator[](size_t cpu) const noexcept {
+    return slots[cpu].val;
+  }
+
+  // call fn(T &) on every instance
+  template <typename Fn>
+  void for_each(Fn &&fn) noexcept {
+    for (auto &slot : slots) {
+      fn(slot.val);
+    }
+  }
+  template <typename Fn>
+  void for_each(Fn &&fn) const noexcept {
+    for (const auto &slot : slots) {
+      fn(slot.val);
+    }
+  }
+
+  [[nodiscard]] static constexpr size_t size() noexcept { return MaxCpu; }
+};
+
+template <size_t MaxCpu, cpu_id_hook CpuId>
+class sharded_counter_t {
+  percpu_t<std::atomic<uint64_t>, MaxCpu, CpuId> shards;
+
+ public:
+  sharded_counter_t() noexcept = default;
+  explicit sharded_counter_t(CpuId hook) noexcept : shards(std::move(hook)) {}
+
+  // atomic on the local slot, stays correct if the caller migrates
+  FORCE_INLINE void add(uint64_t val = 1) noexcept {
+    shards.local().fetch_add(val, std::memory_order_relaxed);
+  }
+  FORCE_INLINE void sub(uint64_t val = 1) noexcept {
+    shards.local().fetch_sub(val, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief sum of every slot, wraps like the unsigned counter it models
+   */
+  [[nodiscard]] uint64_t read() const noexcept {
+    uint64_t sum = 0;
+    shards.for_each([&](const std::atomic<uint64_t> &slot) {
+      sum += slot.load(std::memory_order_relaxed);
+    });
+    return sum;
+  }
+
+  // read and zero, increments racing with it land in either result
+  uint64_t exchange() noexcept {
+    uint64_t sum = 0;
+    shards.for_each([&](std::atomic<uint64_t> &slot) {
+      sum += slot.exchange(0, std::memory_order_relaxed);
+    });
+    return sum;
+  }
+};
+
+}  // namespace bsl
@@ -0,0 +1,181 @@
+#pragma once
+
+/*
+Perfect Hashing
+make_phf builds a collision free table over a compile time list of sv_t
+keys (CHD, hash and displace), construction is consteval, a lookup is one
+hash_sv, a displacement load, a slot load and one memcmp, replacing chains
+of strcmp for command dispatch, config keys and property names
+
+  static constexpr bsl::sv_t cmd_keys[] = {"help", "reboot", "status"};
+  static constexpr auto cmds = bsl::make_phf(cmd_keys);
+  switch (cmds.find(name)) {
+    case cmds.index("reboot"): ...
+  }
+
+find returns the key's position in the original list, or npos
+*/
+
+#include <bsl/cstring.h>
+#include <bsl/hash.h>
+#include <bsl/string_view.h>
+#include <config.h>
+
+#include <bit>
+
+namespace bsl {
+
+// never defined, reaching them in constant evaluation fails the build
+void phf_duplicate_key() noexcept;
+void phf_missing_key() noexcept;
+void phf_no_table() noexcept;
+
+template <size_t N>
+class phf_t {
+  static_assert(N > 0 && N <= 16384, "key count out of range");
+
+ public:
+  static constexpr size_t npos = N;
+
+ private:
+  // twice the keys rounded to a power of 2, easy to place, small to store
+  static constexpr size_t SLOTS = std::bit_ceil(N) * 2;
+  static constexpr size_t BUCKETS = std::bit_ceil((N + 3) / 4);
+
+  struct slot_t {
+    sv_t key;
+    size_t idx = npos;
+  };
+
+  uint64_t seed = 0;
+  uint16_t disp[BUCKETS] = {};
+  slot_t slots[SLOTS] = {};
+
+  static constexpr size_t bucket_of(uint64_t hash) noexcept {
+    return (size_t)((hash * 0x9e3779b97f4a7c15) >> 40) & (BUCKETS - 1);
+  }
+  // odd stride, so displacements 0 .. SLOTS - 1 visit every slot
+  static constexpr size_t slot_of(uint64_t hash, uint64_t d) noexcept {
+    return (size_t)((uint32_t)hash + d * ((uint32_t)(hash >> 32) | 1U)) &
+           (SLOTS - 1);
+  }
+
+  constexpr bool build(const sv_t (&keys)[N]) noexcept {
+    uint64_t hashes[N] = {};
+    size_t sizes[BUCKETS] = {};
+    size_t max_size = 0;
+    for (size_t i = 0; i < N; ++i) {
+      hashes[i] = hash_sv(keys[i], seed);
+      auto sz = ++sizes[bucket_of(hashes[i])];
+      max_size = sz > max_size ? sz : max_size;
+    }
+    // counting sort of the keys by bucket, members of b are
+    // order[start[b] .. start[b] + sizes[b])
+    size_t start[BUCKETS] = {};
+    for (size_t b = 1; b < BUCKETS; ++b) {
+      start[b] = start[b - 1] + sizes[b - 1];
+    }
+    size_t order[N] = {};
+    size_t fill[BUCKETS] = {};
+    for (size_t i = 0; i < N; ++i) {
+      auto b = bucket_of(hashes[i]);
+      order[start[b] + fill[b]++] = i;
+    }
+    for (auto &slot : slots) {
+      slot = {};
+    }
+    // place the largest buckets first, they are the hardest to fit
+    for (auto sz = max_size; sz > 0; --sz) {
+      for (size_t b = 0; b < BUCKETS; ++b) {
+        if (sizes[b] != sz) {
+          continue;
+        }
+        const auto *members = order + start[b];
+        size_t cnt = sizes[b];
+        // equal keys hash alike, so only keys sharing a hash need comparing
+        for (size_t m = 0; m < cnt; ++m) {
+          for (size_t k = 0; k < m; ++k) {
+            if (hashes[members[m]] == hashes[members[k]] &&
+                keys[members[m]] == keys[members[k]]) {
+              phf_duplicate_key();
+            }
+          }
+        }
+        bool placed = false;
+        for (uint64_t d = 0; d < SLOTS && !placed; ++d) {
+          placed = true;
+          for (size_t m = 0; m < cnt && placed; ++m) {
+            auto s = slot_of(hashes[members[m]], d);
+            placed = slots[s].idx == npos;
+            for (size_t k = 0; k < m && placed; ++k) {
+              placed = slot_of(hashes[members[k]], d) != s;
+            }
+          }
+          if (placed) {
+            disp[b] = (uint16_t)d;
+            for (size_t m = 0; m < cnt; ++m) {
+              slots[slot_of(hashes[members[m]], d)] = {keys[members[m]],
+                                                       members[m]};
+            }
+          }
+        }
+        if (!placed) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  template <size_t M>
+  friend consteval phf_t<M> make_phf(const sv_t (&keys)[M]);
+
+ public:
+  /**
+   * @brief position of key in the key list
+   * @return index, npos if key is not in the set
+   */
+  [[nodiscard]] constexpr size_t find(sv_t key) const noexcept {
+    auto hash = hash_sv(key, seed);
+    const auto &slot = slots[slot_of(hash, disp[bucket_of(hash)])];
+    if (slot.idx == npos || slot.key.size() != key.size() ||
+        memcmp(slot.key.data(), key.data(), key.size()) != 0) {
+      return npos;
+    }
+    return slot.idx;
+  }
+  [[nodiscard]] constexpr bool contains(sv_t key) const noexcept {
+    return find(key) != npos;
+  }
+
+  // index of a key known to be in the set, for case labels
+  [[nodiscard]] consteval size_t index(sv_t key) const {
+    auto ret = find(key);
+    if (ret == npos) {
+      phf_missing_key();
+    }
+    return ret;
+  }
+
+  [[nodiscard]] static constexpr size_t size() noexcept { return N; }
+};
+
+/**
+ * @brief build a perfect hash table over keys at compile time
+ * @param keys distinct keys, the table refers to their storage, duplicates
+ * fail the build
+ */
+template <size_t N>
+consteval phf_t<N> make_phf(const sv_t (&keys)[N]) {
+  phf_t<N> ret;
+  for (uint64_t attempt = 0; attempt < 64; ++attempt) {
+    ret.seed = hash64(attempt);
+    if (ret.build(keys)) {
+      return ret;
+    }
+  }
+  phf_no_table();
+  return ret;
+}
+
+}  // namespace bsl
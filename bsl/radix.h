@@ -0,0 +1,417 @@
+#pragma once
+
+/*
+Radix Tree
+Sparse map from uint64_t keys to T *, xarray style, 64-way nodes indexed
+by 6 key bits per level, the tree is only as tall as the largest key needs,
+so keys below 64 take one load, below 4096 two, and densely clustered keys
+cost close to an array lookup
+
+Every node keeps an occupancy bitmap and one bitmap per mark (e.g. dirty,
+writeback), a mark bit on an interior slot means some entry below carries
+the mark, range iteration and marked searches walk the bitmaps and skip
+empty or unmarked subtrees entirely
+
+find, find_next and for_each are lock-free and may run concurrently with
+one writer, writers must be serialized by the caller, nodes come from a
+pluggable allocator, with concurrent readers its deallocate must defer the
+free past a grace period (e.g. retire through epoch_t)
+*/
+
+#include <bsl/alloc.h>
+#include <config.h>
+
+#include <atomic>
+#include <bit>
+#include <new>
+#include <utility>
+
+namespace bsl {
+
+/**
+ * @brief sparse radix tree
+ * @tparam T entry type, the tree stores T *
+ * @tparam Marks number of searchable marks
+ * @tparam Alloc node allocator
+ */
+template <typename T, size_t Marks = 2, allocator Alloc = heap_alloc_t>
+class radix_tree_t {
+  static constexpr unsigned BITS = 6;
+  static constexpr unsigned FANOUT = 1U << BITS;
+  static constexpr unsigned MAX_DEPTH = (64 + BITS - 1) / BITS;
+  // pseudo mark selecting the occupancy bitmap
+  static constexpr size_t PRESENT = ~(size_t)0;
+
+  struct CL_ALIGN node_t {
+    // children, or entries in a leaf (shift == 0)
+    std::atomic<void *> slots[FANOUT] = {};
+    std::atomic<uint64_t> present{0};
+    std::atomic<uint64_t> marks[Marks > 0 ? Marks : 1] = {};
+    unsigned shift = 0;
+  };
+
+  std::atomic<node_t *> root{nullptr};
+  [[no_unique_address]] Alloc alloc{};
+
+  static constexpr unsigned idx(uint64_t key, unsigned shift) noexcept {
+    return (unsigned)(key >> shift) & (FANOUT - 1);
+  }
+  // largest key reachable below a node at shift
+  static constexpr uint64_t max_key(unsigned shift) noexcept {
+    return shift + BITS >= 64 ? ~0ULL : (1ULL << (shift + BITS)) - 1;
+  }
+
+  // writer side bit updates, readers only load
+  static void set_bit(std::atomic<uint64_t> &map, unsigned i) noexcept {
+    map.store(map.load(std::memory_order_relaxed) | (1ULL << i),
+              std::memory_order_release);
+  }
+  static void clear_bit(std::atomic<uint64_t> &map, unsigned i) noexcept {
+    map.store(map.load(std::memory_order_relaxed) & ~(1ULL << i),
+              std::memory_order_release);
+  }
+
+  node_t *new_node(unsigned shift) noexcept {
+    auto *mem = alloc.allocate(sizeof(node_t), alignof(node_t));
+    if (mem == nullptr) [[unlikely]] {
+      return nullptr;
+    }
+    auto *node = new (mem) node_t{};
+    node->shift = shift;
+    return node;
+  }
+  void free_node(node_t *node) noexcept {
+    node->~node_t();
+    alloc.deallocate(node, sizeof(node_t), alignof(node_t));
+  }
+
+  // add levels on top until key fits
+  bool grow(uint64_t key) noexcept {
+    auto *top = root.load(std::memory_order_relaxed);
+    if (top == nullptr) {
+      unsigned shift = 0;
+      while (key > max_key(shift)) {
+        shift += BITS;
+      }
+      top = new_node(shift);
+      if (top == nullptr) [[unlikely]] {
+        return false;
+      }
+      root.store(top, std::memory_order_release);
+      return true;
+    }
+    while (key > max_key(top->shift)) {
+      auto *node = new_node(top->shift + BITS);
+      if (node == nullptr) [[unlikely]] {
+        return false;
+      }
+      node->slots[0].store(top, std::memory_order_relaxed);
+      node->present.store(1, std::memory_order_relaxed);
+      for (size_t m = 0; m < Marks; ++m) {
+        if (top->marks[m].load(std::memory_order_relaxed) != 0) {
+          node->marks[m].store(1, std::memory_order_relaxed);
+        }
+      }
+      root.store(node, std::memory_order_release);
+      top = node;
+    }
+    return true;
+  }
+
+  /**
+   * @brief record the root to leaf path of key
+   * @return path length, the last node is the deepest one present
+   */
+  unsigned walk(uint64_t key, node_t **path) const noexcept {
+    auto *node = root.load(std::memory_order_relaxed);
+    if (node == nullptr || key > max_key(node->shift)) {
+      return 0;
+    }
+    unsigned depth = 0;
+    while (true) {
+      path[depth++] = node;
+      if (node->shift == 0) {
+        return depth;
+      }
+      auto *child = static_cast<node_t *>(
+          node->slots[idx(key, node->shift)].load(std::memory_order_relaxed));
+      if (child == nullptr) {
+        return depth;
+      }
+      node = child;
+    }
+  }
+
+  // free empty nodes and clear stale marks bottom up along path
+  void collapse(uint64_t key, node_t **path, unsigned depth) noexcept {
+    for (auto d = depth; d-- > 1;) {
+      auto *node = path[d];
+      auto *parent = path[d - 1];
+      auto i = idx(key, parent->shift);
+      if (node->present.load(std::memory_order_relaxed) == 0) {
+        parent->slots[i].store(nullptr, std::memory_order_release);
+        clear_bit(parent->present, i);
+        for (size_t m = 0; m < Marks; ++m) {
+          clear_bit(parent->marks[m], i);
+        }
+        free_node(node);
+        continue;
+      }
+      for (size_t m = 0; m < Marks; ++m) {
+        if (node->marks[m].load(std::memory_order_relaxed) == 0) {
+          clear_bit(parent->marks[m], i);
+        }
+      }
+    }
+    if (depth > 0 && path[0]->present.load(std::memory_order_relaxed) == 0) {
+      root.store(nullptr, std::memory_order_release);
+      free_node(path[0]);
+    }
+  }
+
+  // first entry at or after start below node, on the present or mark map
+  static T *next_in(const node_t *node, uint64_t start, uint64_t &key,
+                    size_t mark) noexcept {
+    auto shift = node->shift;
+    auto first = idx(start, shift);
+    auto prefix = shift + BITS >= 64 ? 0 : start & ~max_key(shift);
+    const auto &bitmap = mark == PRESENT ? node->present : node->marks[mark];
+    auto bits = bitmap.load(std::memory_order_acquire) & (~0ULL << first);
+    while (bits != 0) {
+      auto i = (unsigned)std::countr_zero(bits);
+      bits &= bits - 1;
+      auto *slot = node->slots[i].load(std::memory_order_acquire);
+      if (slot == nullptr) {
+        continue;
+      }
+      auto base = prefix | ((uint64_t)i << shift);
+      if (shift == 0) {
+        key = base;
+        return static_cast<T *>(slot);
+      }
+      auto *ret = next_in(static_cast<const node_t *>(slot),
+                          i == first ? start : base, key, mark);
+      if (ret != nullptr) {
+        return ret;
+      }
+    }
+    return nullptr;
+  }
+
+  template <typename Fn>
+  static void visit(const node_t *node, uint64_t prefix, uint64_t first,
+                    uint64_t last, Fn &fn) noexcept {
+    auto shift = node->shift;
+    auto lo = first <= prefix ? 0 : idx(first, shift);
+    auto hi = last >= (prefix | max_key(shift)) ? FANOUT - 1 : idx(last, shift);
+    auto bits = node->present.load(std::memory_order_acquire) &
+                (~0ULL << lo) & (~0ULL >> (FANOUT - 1 - hi));
+    while (bits != 0) {
+      auto i = (unsigned)std::countr_zero(bits);
+      bits &= bits - 1;
+      auto *slot = node->slots[i].load(std::memory_order_acquire);
+      if (slot == nullptr) {
+        continue;
+      }
+      auto base = prefix | ((uint64_t)i << shift);
+      if (shift == 0) {
+        fn(base, static_cast<T *>(slot));
+      } else {
+        visit(static_cast<const node_t *>(slot), base, first, last, fn);
+      }
+    }
+  }
+
+  void destroy(node_t *node) noexcept {
+    if (node->shift != 0) {
+      auto bits = node->present.load(std::memory_order_relaxed);
+      while (bits != 0) {
+        auto i = (unsigned)std::countr_zero(bits);
+        bits &= bits - 1;
+        destroy(static_cast<node_t *>(
+            node->slots[i].load(std::memory_order_relaxed)));
+      }
+    }
+    free_node(node);
+  }
+
+ public:
+  radix_tree_t() noexcept = default;
+  explicit radix_tree_t(Alloc alloc) noexcept : alloc(std::move(alloc)) {}
+  radix_tree_t(const radix_tree_t &) = delete;
+  radix_tree_t &operator=(const radix_tree_t &) = delete;
+  ~radix_tree_t() noexcept { clear(); }
+
+  /**
+   * @brief entry of key, lock-free
+   * @return entry, nullptr if absent
+   */
+  [[nodiscard]] T *find(uint64_t key) const noexcept {
+    const auto *node = root.load(std::memory_order_acquire);
+    if (node == nullptr || key > max_key(node->shift)) {
+      return nullptr;
+    }
+    while (true) {
+      auto *slot =
+          node->slots[idx(key, node->shift)].load(std::memory_order_acquire);
+      if (node->shift == 0 || slot == nullptr) {
+        return static_cast<T *>(slot);
+      }
+      node = static_cast<const node_t *>(slot);
+    }
+  }
+
+  /**
+   * @brief insert entry at key
+   * @param val entry, not nullptr
+   * @return false if key is present or a node allocation failed
+   */
+  bool insert(uint64_t key, T *val) noexcept {
+    if (!grow(key)) [[unlikely]] {
+      return false;
+    }
+    node_t *path[MAX_DEPTH];
+    auto depth = walk(key, path);
+    auto *node = path[depth - 1];
+    while (node->shift != 0) {
+      auto *child = new_node(node->shift - BITS);
+      if (child == nullptr) [[unlikely]] {
+        collapse(key, path, depth);
+        return false;
+      }
+      auto i = idx(key, node->shift);
+      node->slots[i].store(child, std::memory_order_release);
+      set_bit(node->present, i);
+      path[depth++] = child;
+      node = child;
+    }
+    auto i = idx(key, 0);
+    if (node->slots[i].load(std::memory_order_relaxed) != nullptr) {
+      return false;
+    }
+    node->slots[i].store(val, std::memory_order_release);
+    set_bit(node->present, i);
+    return true;
+  }
+
+  /**
+   * @brief remove the entry at key and its marks
+   * @return removed entry, nullptr if absent
+   */
+  T *erase(uint64_t key) noexcept {
+    node_t *path[MAX_DEPTH];
+    auto depth = walk(key, path);
+    if (depth == 0 || path[depth - 1]->shift != 0) {
+      return nullptr;
+    }
+    auto *leaf = path[depth - 1];
+    auto i = idx(key, 0);
+    auto *val = leaf->slots[i].load(std::memory_order_relaxed);
+    if (val == nullptr) {
+      return nullptr;
+    }
+    leaf->slots[i].store(nullptr, std::memory_order_release);
+    clear_bit(leaf->present, i);
+    for (size_t m = 0; m < Marks; ++m) {
+      clear_bit(leaf->marks[m], i);
+    }
+    collapse(key, path, depth);
+    return static_cast<T *>(val);
+  }
+
+  /**
+   * @brief set mark on the entry at key
+   * @return false if key is absent
+   */
+  bool set_mark(uint64_t key, size_t mark) noexcept {
+    node_t *path[MAX_DEPTH];
+    auto depth = walk(key, path);
+    if (depth == 0 || path[depth - 1]->shift != 0 ||
+        path[depth - 1]->slots[idx(key, 0)].load(std::memory_order_relaxed) ==
+            nullptr) {
+      return false;
+    }
+    for (unsigned d = 0; d < depth; ++d) {
+      set_bit(path[d]->marks[mark], idx(key, path[d]->shift));
+    }
+    return true;
+  }
+
+  void clear_mark(uint64_t key, size_t mark) noexcept {
+    node_t *path[MAX_DEPTH];
+    auto depth = walk(key, path);
+    if (depth == 0 || path[depth - 1]->shift != 0) {
+      return;
+    }
+    for (auto d = depth; d-- > 0;) {
+      clear_bit(path[d]->marks[mark], idx(key, path[d]->shift));
+      if (path[d]->marks[mark].load(std::memory_order_relaxed) != 0) {
+        break;
+      }
+    }
+  }
+
+  [[nodiscard]] bool get_mark(uint64_t key, size_t mark) const noexcept {
+    node_t *path[MAX_DEPTH];
+    auto depth = walk(key, path);
+    if (depth == 0 || path[depth - 1]->shift != 0) {
+      return false;
+    }
+    auto bits = path[depth - 1]->marks[mark].load(std::memory_order_acquire);
+    return ((bits >> idx(key, 0)) & 1U) != 0;
+  }
+
+  /**
+   * @brief first entry with key >= key, lock-free
+   * @param key start key, set to the key of the entry found
+   * @return entry, nullptr if none
+   */
+  T *find_next(uint64_t &key) const noexcept {
+    const auto *node = root.load(std::memory_order_acquire);
+    if (node == nullptr || key > max_key(node->shift)) {
+      return nullptr;
+    }
+    return next_in(node, key, key, PRESENT);
+  }
+
+  /**
+   * @brief first entry with key >= key carrying mark, lock-free
+   * @param key start key, set to the key of the entry found
+   * @return entry, nullptr if none
+   */
+  T *find_next_marked(uint64_t &key, size_t mark) const noexcept {
+    const auto *node = root.load(std::memory_order_acquire);
+    if (node == nullptr || key > max_key(node->shift)) {
+      return nullptr;
+    }
+    return next_in(node, key, key, mark);
+  }
+
+  /**
+   * @brief call fn(uint64_t key, T *) on every entry in [first, last] in key
+   * order, lock-free
+   */
+  template <typename Fn>
+  void for_each(uint64_t first, uint64_t last, Fn &&fn) const noexcept {
+    const auto *node = root.load(std::memory_order_acquire);
+    if (node == nullptr || first > last || first > max_key(node->shift)) {
+      return;
+    }
+    visit(node, 0, first, last, fn);
+  }
+
+  [[nodiscard]] bool empty() const noexcept {
+    return root.load(std::memory_order_relaxed) == nullptr;
+  }
+
+  // drop every entry and free every node, entries are not touched
+  void clear() noexcept {
+    auto *node = root.load(std::memory_order_relaxed);
+    if (node != nullptr) {
+      root.store(nullptr, std::memory_order_release);
+      destroy(node);
+    }
+  }
+};
+
+}  // namespace bsl
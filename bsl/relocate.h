@@ -0,0 +1,61 @@
+#pragma once
+
+#include <bsl/cstring.h>
+#include <config.h>
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace bsl {
+
+// a type is trivially relocatable if moving it and destroying the source
+// is equivalent to copying its bytes, specialize for types that hold
+// pointers to heap memory but never to themselves
+template <typename T>
+struct is_trivially_relocatable
+    : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+/**
+ * @brief move n objects from src to dst, ending the lifetime of the sources
+ * @param dst destination, uninitialized, may overlap src
+ * @param src source objects
+ * @param n number of objects
+ */
+template <typename T>
+INLINE void relocate(T *dst, T *src, size_t n) noexcept {
+  if (dst == src || n == 0) {
+    return;
+  }
+  if constexpr (is_trivially_relocatable_v<T>) {
+    bsl::memmove((void *)dst, (const void *)src, n * sizeof(T));
+  } else if (dst < src) {
+    for (size_t i = 0; i < n; ++i) {
+      new (dst + i) T(std::move(src[i]));
+      src[i].~T();
+    }
+  } else {
+    for (size_t i = n; i-- > 0;) {
+      new (dst + i) T(std::move(src[i]));
+      src[i].~T();
+    }
+  }
+}
+
+/**
+ * @brief destroy n objects
+ */
+template <typename T>
+INLINE void destroy_n(T *ptr, size_t n) noexcept {
+  if constexpr (!std::is_trivially_destructible_v<T>) {
+    for (size_t i = 0; i < n; ++i) {
+      ptr[i].~T();
+    }
+  }
+}
+
+}  // namespace bsl
@@ -26,6 +26,19 @@ class ring_buf_t {
   ring_buf_t &operator=(ring_buf_t &&) = delete;
   ~ring_buf_t() { delete ring_buf; }
 
+  // elements a read would find now, a hint with several readers
+  uint64_t read_avail() const {
+    return (write_commit.load(std::memory_order_acquire) -
+            read_head.load(std::memory_order_relaxed) + Sz) %
+           Sz;
+  }
+  // room a write would find now, a hint with several writers
+  uint64_t write_avail() const {
+    return (read_commit.load(std::memory_order_acquire) -
+            write_head.load(std::memory_order_relaxed) + Sz - 1) %
+           Sz;
+  }
+
   // non block read
   uint64_t nb_read(Tp *buf, uint64_t size, bool no_partial = false) {
     uint64_t slice_st = read_head;
@@ -0,0 +1,204 @@
+#pragma once
+
+/*
+Static Search
+Read-only sorted tables rearranged for lower_bound, built once (at compile
+time for constexpr tables) from a sorted span
+
+eytzinger_t stores the table in BFS order of an implicit binary tree, the
+descent is branchless (k = 2k + (x > a[k])) and prefetches the cache line
+holding the node's descendants a few levels down, so the misses of one
+lookup overlap, records work through a key extractor
+
+stree_t stores integer keys in an implicit B+1-ary tree of cache line
+nodes (an S-tree), every level is one cache line compared against the key
+with SIMD, log_{B+1}(n) misses instead of log_2(n)
+
+  static constexpr uint32_t ids_sorted[] = {...};
+  static constexpr bsl::stree_t<uint32_t, std::size(ids_sorted)> ids(ids_sorted);
+  auto *p = ids.lower_bound(id);
+
+  bsl::eytzinger_t<sym_t, 4096, sym_addr_t> syms;
+  syms = bsl::eytzinger_t<sym_t, 4096, sym_addr_t>(sorted_syms);
+  auto *sym = syms.lower_bound(pc);
+
+N is the capacity, a span shorter than N builds a smaller table
+lower_bound returns the first element not less than the key, nullptr if
+every element is less
+*/
+
+#include <bsl/simd.h>
+#include <bsl/sort.h>
+#include <bsl/span.h>
+#include <config.h>
+
+#include <bit>
+#include <concepts>
+#include <limits>
+#include <type_traits>
+
+namespace bsl {
+
+/**
+ * @brief Eytzinger layout table
+ * @tparam N capacity
+ * @tparam Key maps an element to its ordering key
+ */
+template <typename T, size_t N, typename Key = sort_identity_t>
+class eytzinger_t {
+  // elements per cache line, a line holds the descendants log2(PREFETCH)
+  // levels below a node
+  static constexpr size_t PREFETCH =
+      sizeof(T) < CACHELINE_SZ ? CACHELINE_SZ / sizeof(T) : 1;
+
+  // 1 based, tree[0] is unused so a node's descendants share a line
+  CL_ALIGN T tree[N + 1] = {};
+  size_t len = 0;
+  [[no_unique_address]] Key key;
+
+  // in-order walk of node k, consumes sorted[idx ..]
+  constexpr size_t build(const T *sorted, size_t idx, size_t k) noexcept {
+    if (k <= len) {
+      idx = build(sorted, idx, 2 * k);
+      tree[k] = sorted[idx++];
+      idx = build(sorted, idx, 2 * k + 1);
+    }
+    return idx;
+  }
+
+ public:
+  constexpr eytzinger_t() noexcept = default;
+
+  /**
+   * @param sorted ascending by key, the first N elements are used
+   */
+  constexpr explicit eytzinger_t(span_t<const T> sorted, Key key = {}) noexcept
+      : len(sorted.size() < N ? sorted.size() : N), key(key) {
+    build(sorted.data(), 0, 1);
+  }
+  constexpr explicit eytzinger_t(const T (&sorted)[N], Key key = {}) noexcept
+      : eytzinger_t(span_t<const T>(sorted), key) {}
+
+  template <typename K>
+  [[nodiscard]] constexpr const T *lower_bound(const K &val) const noexcept {
+    size_t k = 1;
+    while (k <= len) {
+      if (!std::is_constant_evaluated()) {
+        // may point past the table, a prefetch never faults
+        __builtin_prefetch(reinterpret_cast<const void *>(
+            (uintptr_t)tree + k * PREFETCH * sizeof(T)));
+      }
+      k = 2 * k + (size_t)(key(tree[k]) < val);
+    }
+    // undo the right turns taken after the last left turn
+    k >>= std::countr_one(k) + 1;
+    return k != 0 ? &tree[k] : nullptr;
+  }
+
+  // element with key equal to val, nullptr if none
+  template <typename K>
+  [[nodiscard]] constexpr const T *find(const K &val) const noexcept {
+    const auto *ret = lower_bound(val);
+    return ret != nullptr && !(val < key(*ret)) ? ret : nullptr;
+  }
+
+  [[nodiscard]] constexpr size_t size() const noexcept { return len; }
+};
+
+/**
+ * @brief S-tree of integer keys, one cache line per node
+ * @tparam N capacity
+ */
+template <std::integral T, size_t N>
+class stree_t {
+  static constexpr size_t B = CACHELINE_SZ / sizeof(T);
+  static constexpr size_t MAX_NODES = N / B + (N % B != 0 ? 1 : 0);
+  static constexpr T PAD = std::numeric_limits<T>::max();
+
+  struct CL_ALIGN node_t {
+    T keys[B];
+  };
+
+  node_t nodes[MAX_NODES > 0 ? MAX_NODES : 1] = {};
+  size_t nnodes = 0;
+  size_t len = 0;
+  // largest key, keys above it would land on padding
+  T hi = 0;
+
+  static constexpr size_t child(size_t k, size_t i) noexcept {
+    return k * (B + 1) + i + 1;
+  }
+
+  // in-order walk of node k, padding fills the slots past len
+  constexpr size_t build(const T *sorted, size_t idx, size_t k) noexcept {
+    if (k >= nnodes) {
+      return idx;
+    }
+    for (size_t i = 0; i < B; ++i) {
+      idx = build(sorted, idx, child(k, i));
+      nodes[k].keys[i] = idx < len ? sorted[idx] : PAD;
+      ++idx;
+    }
+    return build(sorted, idx, child(k, B));
+  }
+
+  // keys in node less than val
+  static FORCE_INLINE constexpr size_t rank(const node_t &node,
+                                            T val) noexcept {
+    if (std::is_constant_evaluated()) {
+      size_t ret = 0;
+      for (auto k : node.keys) {
+        ret += (size_t)(k < val);
+      }
+      return ret;
+    }
+    typedef T vec_t __attribute__((vector_size(SIMD_WIDTH)));
+    constexpr size_t LANES = SIMD_WIDTH / sizeof(T);
+    auto splat = vec_t{} + val;
+    size_t bytes = 0;
+    for (size_t i = 0; i < B; i += LANES) {
+      auto less = simd_load<vec_t>(&node.keys[i]) < splat;
+      bytes += (size_t)std::popcount(simd_mask((u8xw_t)less));
+    }
+    return bytes / sizeof(T);
+  }
+
+ public:
+  constexpr stree_t() noexcept = default;
+
+  /**
+   * @param sorted ascending, the first N keys are used
+   */
+  constexpr explicit stree_t(span_t<const T> sorted) noexcept
+      : nnodes((sorted.size() < N ? sorted.size() : N) / B +
+               ((sorted.size() < N ? sorted.size() : N) % B != 0 ? 1 : 0)),
+        len(sorted.size() < N ? sorted.size() : N),
+        hi(len != 0 ? sorted[len - 1] : 0) {
+    build(sorted.data(), 0, 0);
+  }
+  constexpr explicit stree_t(const T (&sorted)[N]) noexcept
+      : stree_t(span_t<const T>(sorted)) {}
+
+  [[nodiscard]] constexpr const T *lower_bound(T val) const noexcept {
+    if (len == 0 || val > hi) {
+      return nullptr;
+    }
+    const T *ret = nullptr;
+    size_t k = 0;
+    while (k < nnodes) {
+      auto i = rank(nodes[k], val);
+      ret = i < B ? &nodes[k].keys[i] : ret;
+      k = child(k, i);
+    }
+    return ret;
+  }
+
+  [[nodiscard]] constexpr bool contains(T val) const noexcept {
+    const auto *ret = lower_bound(val);
+    return ret != nullptr && *ret == val;
+  }
+
+  [[nodiscard]] constexpr size_t size() const noexcept { return len; }
+};
+
+}  // namespace bsl
@@ -0,0 +1,184 @@
+#pragma once
+
+/*
+Sequence Locks
+seqlock_t<T>: readers copy the value out and retry if a writer ran
+concurrently, they never write shared memory, so read throughput scales
+with cores, writers are serialized on the sequence word (odd while a write
+is in progress)
+mvseqlock_t<T, N>: keeps N versions, a writer fills the version after the
+current one and then publishes it, readers read the current version and
+never wait for a writer in progress, they retry only when lapped by N - 1
+complete writes during one read
+
+T must be trivially copyable, the value is held as relaxed atomic words so
+torn reads are detected instead of being data races
+*/
+
+#include <bsl/cpu.h>
+#include <config.h>
+
+#include <atomic>
+#include <type_traits>
+
+namespace bsl {
+
+// value of T stored as relaxed atomic words
+template <typename T>
+class seq_data_t {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "seqlock value must be trivially copyable");
+  static constexpr size_t words = (sizeof(T) + 7) / 8;
+
+  std::atomic<uint64_t> data[words] = {};
+
+ public:
+  FORCE_INLINE void load(T &out) const noexcept {
+    uint64_t tmp[words];
+    for (size_t i = 0; i < words; ++i) {
+      tmp[i] = data[i].load(std::memory_order_relaxed);
+    }
+    __builtin_memcpy(&out, tmp, sizeof(T));
+  }
+  FORCE_INLINE void store(const T &val) noexcept {
+    uint64_t tmp[words] = {};
+    __builtin_memcpy(tmp, &val, sizeof(T));
+    for (size_t i = 0; i < words; ++i) {
+      data[i].store(tmp[i], std::memory_order_relaxed);
+    }
+  }
+};
+
+template <typename T>
+class CL_ALIGN seqlock_t {
+  std::atomic<uint64_t> seq{0};
+  seq_data_t<T> data;
+
+  // take the write side, seq becomes odd
+  uint64_t write_begin() noexcept {
+    backoff_t<> backoff;
+    while (true) {
+      auto cur = seq.load(std::memory_order_relaxed);
+      if ((cur & 1U) == 0 &&
+          seq.compare_exchange_weak(cur, cur + 1, std::memory_order_relaxed,
+                                    std::memory_order_relaxed)) {
+        // order the odd sequence before the data stores
+        std::atomic_thread_fence(std::memory_order_release);
+        return cur + 1;
+      }
+      backoff.pause();
+    }
+  }
+  void write_end(uint64_t cur) noexcept {
+    seq.store(cur + 1, std::memory_order_release);
+  }
+
+ public:
+  seqlock_t() noexcept = default;
+  explicit seqlock_t(const T &val) noexcept { data.store(val); }
+  seqlock_t(const seqlock_t &) = delete;
+  seqlock_t &operator=(const seqlock_t &) = delete;
+
+  /**
+   * @brief consistent copy of the value, retries while a write overlaps
+   */
+  [[nodiscard]] T read() const noexcept {
+    T ret;
+    while (true) {
+      auto st = seq.load(std::memory_order_acquire);
+      if ((st & 1U) != 0) [[unlikely]] {
+        cpu_relax();
+        continue;
+      }
+      data.load(ret);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq.load(std::memory_order_relaxed) == st) [[likely]] {
+        return ret;
+      }
+    }
+  }
+
+  void write(const T &val) noexcept {
+    auto cur = write_begin();
+    data.store(val);
+    write_end(cur);
+  }
+
+  /**
+   * @brief read-modify-write under the write side
+   * @param fn called as fn(T &)
+   */
+  template <typename Fn>
+  void update(Fn &&fn) noexcept {
+    auto cur = write_begin();
+    T val;
+    data.load(val);
+    fn(val);
+    data.store(val);
+    write_end(cur);
+  }
+
+  // sequence number, advances by 2 per write
+  [[nodiscard]] uint64_t sequence() const noexcept {
+    return seq.load(std::memory_order_acquire);
+  }
+};
+
+template <typename T, size_t N = 2>
+class mvseqlock_t {
+  static_assert(N >= 2, "need a spare version for the writer");
+
+  struct CL_ALIGN version_t {
+    std::atomic<uint64_t> seq{0};
+    seq_data_t<T> data;
+  };
+
+  // index of the published version, advances by 1 per write
+  CL_ALIGN std::atomic<uint64_t> cur{0};
+  std::atomic<bool> writer{false};
+  version_t versions[N];
+
+ public:
+  mvseqlock_t() noexcept = default;
+  explicit mvseqlock_t(const T &val) noexcept { versions[0].data.store(val); }
+  mvseqlock_t(const mvseqlock_t &) = delete;
+  mvseqlock_t &operator=(const mvseqlock_t &) = delete;
+
+  /**
+   * @brief consistent copy of the latest published value
+   */
+  [[nodiscard]] T read() const noexcept {
+    T ret;
+    while (true) {
+      const auto &ver = versions[cur.load(std::memory_order_acquire) % N];
+      auto st = ver.seq.load(std::memory_order_acquire);
+      if ((st & 1U) != 0) [[unlikely]] {
+        // lapped, a newer version is already published
+        continue;
+      }
+      ver.data.load(ret);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (ver.seq.load(std::memory_order_relaxed) == st) [[likely]] {
+        return ret;
+      }
+    }
+  }
+
+  void write(const T &val) noexcept {
+    backoff_t<> backoff;
+    while (writer.exchange(true, std::memory_order_acquire)) {
+      backoff.pause();
+    }
+    auto next = cur.load(std::memory_order_relaxed) + 1;
+    auto &ver = versions[next % N];
+    auto st = ver.seq.load(std::memory_order_relaxed);
+    ver.seq.store(st + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ver.data.store(val);
+    ver.seq.store(st + 2, std::memory_order_release);
+    cur.store(next, std::memory_order_release);
+    writer.store(false, std::memory_order_release);
+  }
+};
+
+}  // namespace bsl
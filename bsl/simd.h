@@ -0,0 +1,89 @@
+#pragma once
+
+#include <config.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace bsl {
+
+// generic vector types, lowered to SSE/AVX or NEON by the compiler
+typedef uint8_t u8x16_t __attribute__((vector_size(16)));
+typedef uint8_t u8x32_t __attribute__((vector_size(32)));
+typedef uint64_t u64x2_t __attribute__((vector_size(16)));
+typedef uint64_t u64x4_t __attribute__((vector_size(32)));
+
+// widest byte vector worth using on the target
+#if defined(__AVX2__)
+using u8xw_t = u8x32_t;
+#else
+using u8xw_t = u8x16_t;
+#endif
+constexpr auto SIMD_WIDTH = sizeof(u8xw_t);
+
+/**
+ * @brief unaligned vector load
+ * @param ptr source, no alignment requirement
+ * @return vector
+ */
+template <typename V>
+FORCE_INLINE V simd_load(const void *ptr) noexcept {
+  V v;
+  __builtin_memcpy(&v, ptr, sizeof(V));
+  return v;
+}
+
+/**
+ * @brief unaligned vector store
+ * @param ptr destination, no alignment requirement
+ * @param v vector
+ */
+template <typename V>
+FORCE_INLINE void simd_store(void *ptr, V v) noexcept {
+  __builtin_memcpy(ptr, &v, sizeof(V));
+}
+
+/**
+ * @brief collect the top bit of every byte lane into a bitmask
+ * @param v vector of 0x00 / 0xFF lanes, e.g. a compare result
+ * @return bit i set if lane i is set
+ */
+FORCE_INLINE uint32_t simd_mask(u8x16_t v) noexcept {
+#if defined(__SSE2__)
+  return (uint32_t)_mm_movemask_epi8((__m128i)v);
+#elif defined(__ARM_NEON)
+  const uint8x16_t weight = {1, 2, 4, 8, 16, 32, 64, 128,
+                             1, 2, 4, 8, 16, 32, 64, 128};
+  auto bits = vandq_u8((uint8x16_t)v, weight);
+  return (uint32_t)vaddv_u8(vget_low_u8(bits)) |
+         ((uint32_t)vaddv_u8(vget_high_u8(bits)) << 8U);
+#else
+  uint32_t mask = 0;
+  for (unsigned i = 0; i < 16; ++i) {
+    mask |= (uint32_t)(v[i] >> 7U) << i;
+  }
+  return mask;
+#endif
+}
+
+FORCE_INLINE uint32_t simd_mask(u8x32_t v) noexcept {
+#if defined(__AVX2__)
+  return (uint32_t)_mm256_movemask_epi8((__m256i)v);
+#else
+  auto lo = __builtin_shufflevector(v, v, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                    12, 13, 14, 15);
+  auto hi = __builtin_shufflevector(v, v, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+                                    25, 26, 27, 28, 29, 30, 31);
+  return simd_mask(lo) | (simd_mask(hi) << 16U);
+#endif
+}
+
+// mask value with every lane of a vector set
+template <typename V>
+constexpr uint32_t SIMD_FULL_MASK =
+    sizeof(V) >= 32 ? 0xFFFFFFFFU : (1U << sizeof(V)) - 1;
+
+}  // namespace bsl
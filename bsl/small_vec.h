@@ -0,0 +1,337 @@
+#pragma once
+
+#include <bsl/alloc.h>
+#include <bsl/relocate.h>
+#include <config.h>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace bsl {
+
+// vector keeping the first N elements in inline storage, spills to Alloc
+// when it overflows and grows geometrically from there, moves between
+// buffers relocate, which is a memcpy for trivially relocatable T
+// allocation failure is reported by the return value, never by exception
+template <typename T, size_t N, allocator Alloc = heap_alloc_t>
+class small_vec {
+ public:
+  using type = small_vec<T, N, Alloc>;
+  using value_type = T;
+  using allocator_type = Alloc;
+  using iterator = T *;
+  using const_iterator = const T *;
+
+ private:
+  T *_data = inline_ptr();
+  uint64_t _size = 0;
+  uint64_t _cap = N;
+  [[no_unique_address]] Alloc _alloc{};
+  alignas(T) unsigned char _buf[N * sizeof(T)];
+
+  T *inline_ptr() noexcept {
+    return std::launder(reinterpret_cast<T *>(_buf));
+  }
+
+  void release() noexcept {
+    if (!is_inline()) {
+      _alloc.deallocate(_data, _cap * sizeof(T), alignof(T));
+    }
+  }
+
+  // take other's elements, other is left empty and inline
+  void steal(type &other) noexcept {
+    if (other.is_inline()) {
+      relocate(_data, other._data, other._size);
+    } else {
+      _data = std::exchange(other._data, other.inline_ptr());
+      _cap = std::exchange(other._cap, N);
+    }
+    _size = std::exchange(other._size, 0);
+  }
+
+  // buffer for at least cap elements, the current one is left untouched
+  T *alloc_buf(uint64_t cap, uint64_t &new_cap) noexcept {
+    new_cap = std::max(cap, _cap * 2);
+    return (T *)_alloc.allocate(new_cap * sizeof(T), alignof(T));
+  }
+
+  // move every element into ptr leaving count slots at idx, each element
+  // is relocated once, then free the old buffer
+  void adopt(T *ptr, uint64_t new_cap, uint64_t idx, uint64_t count) noexcept {
+    relocate(ptr, _data, idx);
+    relocate(ptr + idx + count, _data + idx, _size - idx);
+    release();
+    _data = ptr;
+    _cap = new_cap;
+  }
+
+  // open count uninitialized slots at idx, capacity must suffice
+  T *shift(uint64_t idx, uint64_t count) noexcept {
+    auto *gap = _data + idx;
+    relocate(gap + count, gap, _size - idx);
+    _size += count;
+    return gap;
+  }
+
+  /**
+   * @brief insert count elements at idx, build(gap) constructs them
+   * @param build runs before any existing element moves when the vector
+   * grows, in place it runs after the shift
+   * @return first inserted element, nullptr if allocation failed
+   */
+  template <typename Build>
+  T *insert_n(uint64_t idx, uint64_t count, Build &&build) noexcept(
+      noexcept(build((T *)nullptr))) {
+    if (_size + count <= _cap) {
+      auto *gap = shift(idx, count);
+      build(gap);
+      return gap;
+    }
+    uint64_t new_cap = 0;
+    auto *ptr = alloc_buf(_size + count, new_cap);
+    if (ptr == nullptr) [[unlikely]] {
+      return nullptr;
+    }
+    build(ptr + idx);
+    adopt(ptr, new_cap, idx, count);
+    _size += count;
+    return ptr + idx;
+  }
+
+ public:
+  small_vec() noexcept = default;
+  explicit small_vec(Alloc alloc) noexcept : _alloc(std::move(alloc)) {}
+  small_vec(const type &other) noexcept(
+      std::is_nothrow_copy_constructible_v<T>)
+      : _alloc(other._alloc) {
+    assign(other.begin(), other.end());
+  }
+  small_vec(type &&other) noexcept : _alloc(std::move(other._alloc)) {
+    steal(other);
+  }
+  type &operator=(const type &other) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    if (this != &other) {
+      assign(other.begin(), other.end());
+    }
+    return *this;
+  }
+  type &operator=(type &&other) noexcept {
+    if (this != &other) {
+      clear();
+      release();
+      _data = inline_ptr();
+      _cap = N;
+      // the buffer goes with its allocator, other keeps ours for later use
+      std::swap(_alloc, other._alloc);
+      steal(other);
+    }
+    return *this;
+  }
+  ~small_vec() noexcept {
+    clear();
+    release();
+  }
+
+  /**
+   * @brief make room for at least cap elements
+   * @param cap requested capacity
+   * @return false if allocation failed, vector is unchanged
+   */
+  bool reserve(uint64_t cap) noexcept {
+    if (cap <= _cap) [[likely]] {
+      return true;
+    }
+    uint64_t new_cap = 0;
+    auto *ptr = alloc_buf(cap, new_cap);
+    if (ptr == nullptr) [[unlikely]] {
+      return false;
+    }
+    adopt(ptr, new_cap, _size, 0);
+    return true;
+  }
+
+  /**
+   * @brief construct element at the back
+   * @param args arguments forwards to value constructor
+   * @return pointer to the new element, nullptr if allocation failed
+   */
+  template <typename... Args>
+  T *emplace_back(Args &&...args) noexcept(
+      std::is_nothrow_constructible_v<T, Args...>) {
+    // on growth the element is built before the old buffer goes, args may
+    // refer to an element of this vector
+    return insert_n(_size, 1, [&](T *gap) {
+      new (gap) T(std::forward<Args>(args)...);
+    });
+  }
+
+  // push back forward argument to data, false if allocation failed
+  template <typename... Args>
+  bool push_back(Args &&...args) noexcept(
+      std::is_nothrow_constructible_v<T, Args...>) {
+    return emplace_back(std::forward<Args>(args)...) != nullptr;
+  }
+  void pop_back() noexcept {
+    _size--;
+    _data[_size].~T();
+  }
+
+  /**
+   * @brief construct element before pos
+   * @param pos insert position, in [begin(), end()]
+   * @param args arguments forwards to value constructor, may refer to an
+   * element of this vector
+   * @return pointer to the new element, nullptr if allocation failed
+   */
+  template <typename... Args>
+  T *emplace(const T *pos, Args &&...args) noexcept(
+      std::is_nothrow_constructible_v<T, Args...>) {
+    auto idx = (uint64_t)(pos - _data);
+    if (idx == _size || _size == _cap) {
+      return insert_n(idx, 1, [&](T *gap) {
+        new (gap) T(std::forward<Args>(args)...);
+      });
+    }
+    // the shift would move the elements args refer to
+    T tmp(std::forward<Args>(args)...);
+    return new (shift(idx, 1)) T(std::move(tmp));
+  }
+  T *insert(const T *pos, const T &val) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    return emplace(pos, val);
+  }
+  T *insert(const T *pos, T &&val) noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    return emplace(pos, std::move(val));
+  }
+
+  /**
+   * @brief insert count copies of val before pos, val may be an element of
+   * this vector
+   * @return pointer to the first inserted element, nullptr if allocation
+   * failed
+   */
+  T *insert(const T *pos, uint64_t count, const T &val) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    auto idx = (uint64_t)(pos - _data);
+    if (_size + count > _cap) {
+      return insert_n(idx, count, [&](T *gap) {
+        std::uninitialized_fill_n(gap, count, val);
+      });
+    }
+    T tmp(val);
+    auto *gap = shift(idx, count);
+    std::uninitialized_fill_n(gap, count, tmp);
+    return gap;
+  }
+
+  /**
+   * @brief insert [first, last) before pos, the range must not refer to
+   * this vector
+   * @return pointer to the first inserted element, nullptr if allocation
+   * failed
+   */
+  template <std::forward_iterator Itr>
+  T *insert(const T *pos, Itr first, Itr last) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    return insert_n((uint64_t)(pos - _data),
+                    (uint64_t)std::distance(first, last),
+                    [&](T *gap) { std::uninitialized_copy(first, last, gap); });
+  }
+
+  /**
+   * @brief erase [first, last)
+   * @return pointer to the element after the erased range
+   */
+  T *erase(const T *first, const T *last) noexcept {
+    auto *dst = _data + (first - _data);
+    auto *src = _data + (last - _data);
+    auto count = (uint64_t)(src - dst);
+    destroy_n(dst, count);
+    relocate(dst, src, (uint64_t)(end() - src));
+    _size -= count;
+    return dst;
+  }
+  T *erase(const T *pos) noexcept { return erase(pos, pos + 1); }
+
+  /**
+   * @brief resize, new elements are value initialized or copied from val
+   * @return false if allocation failed, vector is unchanged
+   */
+  bool resize(uint64_t count) noexcept(
+      std::is_nothrow_default_constructible_v<T>) {
+    if (!reserve(count)) [[unlikely]] {
+      return false;
+    }
+    if (count < _size) {
+      destroy_n(_data + count, _size - count);
+    } else {
+      std::uninitialized_value_construct_n(_data + _size, count - _size);
+    }
+    _size = count;
+    return true;
+  }
+  bool resize(uint64_t count, const T &val) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    if (!reserve(count)) [[unlikely]] {
+      return false;
+    }
+    if (count < _size) {
+      destroy_n(_data + count, _size - count);
+    } else {
+      std::uninitialized_fill_n(_data + _size, count - _size, val);
+    }
+    _size = count;
+    return true;
+  }
+
+  /**
+   * @brief replace contents
+   * @return false if allocation failed, vector is left empty
+   */
+  bool assign(uint64_t count, const T &val) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    clear();
+    return resize(count, val);
+  }
+  template <std::forward_iterator Itr>
+  bool assign(Itr first, Itr last) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    clear();
+    return insert(begin(), first, last) != nullptr;
+  }
+
+  void clear() noexcept {
+    destroy_n(_data, _size);
+    _size = 0;
+  }
+
+  [[nodiscard]] uint64_t size() const { return _size; }
+  [[nodiscard]] uint64_t capacity() const { return _cap; }
+  [[nodiscard]] bool empty() const { return _size == 0; }
+  [[nodiscard]] bool is_inline() const {
+    return (const void *)_data == (const void *)_buf;
+  }
+
+  T &operator[](uint64_t idx) { return _data[idx]; }
+  T &back() { return _data[_size - 1]; }
+  T &front() { return _data[0]; }
+  T *data() { return _data; }
+  T *begin() { return _data; }
+  T *end() { return _data + _size; }
+
+  const T &operator[](uint64_t idx) const { return _data[idx]; }
+  [[nodiscard]] const T &back() const { return _data[_size - 1]; }
+  [[nodiscard]] const T &front() const { return _data[0]; }
+  [[nodiscard]] const T *data() const { return _data; }
+  [[nodiscard]] const T *begin() const { return _data; }
+  [[nodiscard]] const T *end() const { return _data + _size; }
+};
+
+}  // namespace bsl
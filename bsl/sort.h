@@ -0,0 +1,546 @@
+#pragma once
+
+/*
+Sorting
+sort is a pattern-defeating quicksort (pdqsort), insertion sort below
+SORT_INSERTION elements, median of 3 (ninther above SORT_NINTHER) pivots,
+already partitioned ranges are finished by a bounded insertion sort, bad
+partitions shuffle the pivot candidates and fall back to heapsort after
+log2(n) of them, O(n log n) worst case, not stable, constexpr, never
+allocates
+
+Arithmetic and pointer elements use a branchless block partition, the
+comparisons of a block are turned into offset lists first and swapped
+afterwards, so a random input costs no mispredicted branch per element
+
+radix_sort is an LSD radix sort on 8 bit digits of an unsigned key, stable,
+the caller supplies a scratch buffer as large as the input, passes where
+every key has the same digit are skipped
+
+  bsl::sort(vec);
+  bsl::sort(vec, [](const auto &a, const auto &b) { return a.prio < b.prio; });
+  bsl::radix_sort(span, scratch, [](const req_t &r) { return r.lba; });
+
+Both take raw pointer ranges, span_t and static_vec (anything with data()
+and size())
+*/
+
+#include <bsl/cmath.h>
+#include <bsl/span.h>
+#include <config.h>
+
+#include <concepts>
+#include <type_traits>
+#include <utility>
+
+namespace bsl {
+
+constexpr size_t SORT_INSERTION = 24;
+constexpr size_t SORT_NINTHER = 128;
+constexpr size_t SORT_PARTIAL_LIMIT = 8;
+constexpr size_t SORT_BLOCK = 64;
+
+struct sort_less_t {
+  template <typename T>
+  constexpr bool operator()(const T &lhs, const T &rhs) const noexcept {
+    return lhs < rhs;
+  }
+};
+
+struct sort_identity_t {
+  template <typename T>
+  constexpr const T &operator()(const T &val) const noexcept {
+    return val;
+  }
+};
+
+template <typename R>
+concept sort_range = requires(R &r) {
+  { r.data() } -> std::convertible_to<const void *>;
+  { r.size() } -> std::convertible_to<size_t>;
+};
+
+template <typename T, typename Cmp>
+constexpr void insertion_sort(T *first, T *last, Cmp &cmp) noexcept {
+  if (first == last) {
+    return;
+  }
+  for (auto *cur = first + 1; cur != last; ++cur) {
+    if (!cmp(*cur, *(cur - 1))) {
+      continue;
+    }
+    T tmp = std::move(*cur);
+    auto *sift = cur;
+    do {
+      *sift = std::move(*(sift - 1));
+      --sift;
+    } while (sift != first && cmp(tmp, *(sift - 1)));
+    *sift = std::move(tmp);
+  }
+}
+
+// *(first - 1) is no greater than any element, no bound check on the sift
+template <typename T, typename Cmp>
+constexpr void unguarded_insertion_sort(T *first, T *last, Cmp &cmp) noexcept {
+  if (first == last) {
+    return;
+  }
+  for (auto *cur = first + 1; cur != last; ++cur) {
+    if (!cmp(*cur, *(cur - 1))) {
+      continue;
+    }
+    T tmp = std::move(*cur);
+    auto *sift = cur;
+    do {
+      *sift = std::move(*(sift - 1));
+      --sift;
+    } while (cmp(tmp, *(sift - 1)));
+    *sift = std::move(tmp);
+  }
+}
+
+// insertion sort giving up after SORT_PARTIAL_LIMIT moves
+template <typename T, typename Cmp>
+constexpr bool partial_insertion_sort(T *first, T *last, Cmp &cmp) noexcept {
+  if (first == last) {
+    return true;
+  }
+  size_t moved = 0;
+  for (auto *cur = first + 1; cur != last; ++cur) {
+    if (!cmp(*cur, *(cur - 1))) {
+      continue;
+    }
+    T tmp = std::move(*cur);
+    auto *sift = cur;
+    do {
+      *sift = std::move(*(sift - 1));
+      --sift;
+    } while (sift != first && cmp(tmp, *(sift - 1)));
+    *sift = std::move(tmp);
+    moved += (size_t)(cur - sift);
+    if (moved > SORT_PARTIAL_LIMIT) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T, typename Cmp>
+constexpr void heap_sift_down(T *base, size_t len, size_t idx,
+                              Cmp &cmp) noexcept {
+  T tmp = std::move(base[idx]);
+  while (true) {
+    auto child = idx * 2 + 1;
+    if (child >= len) {
+      break;
+    }
+    if (child + 1 < len && cmp(base[child], base[child + 1])) {
+      ++child;
+    }
+    if (!cmp(tmp, base[child])) {
+      break;
+    }
+    base[idx] = std::move(base[child]);
+    idx = child;
+  }
+  base[idx] = std::move(tmp);
+}
+
+template <typename T, typename Cmp>
+constexpr void heap_sort(T *first, T *last, Cmp &cmp) noexcept {
+  auto len = (size_t)(last - first);
+  for (auto i = len / 2; i-- > 0;) {
+    heap_sift_down(first, len, i, cmp);
+  }
+  while (len > 1) {
+    --len;
+    std::swap(first[0], first[len]);
+    heap_sift_down(first, len, 0, cmp);
+  }
+}
+
+template <typename T, typename Cmp>
+FORCE_INLINE constexpr void sort2(T *a, T *b, Cmp &cmp) noexcept {
+  if (cmp(*b, *a)) {
+    std::swap(*a, *b);
+  }
+}
+
+template <typename T, typename Cmp>
+FORCE_INLINE constexpr void sort3(T *a, T *b, T *c, Cmp &cmp) noexcept {
+  sort2(a, b, cmp);
+  sort2(b, c, cmp);
+  sort2(a, b, cmp);
+}
+
+template <typename T>
+struct partition_t {
+  T *pivot;
+  bool already_partitioned;
+};
+
+/**
+ * @brief partition around *first, equal elements go right
+ * @return pivot position, whether no element had to move
+ */
+template <typename T, typename Cmp>
+constexpr partition_t<T> partition_right(T *begin, T *end, Cmp &cmp) noexcept {
+  T pivot = std::move(*begin);
+  auto *first = begin;
+  auto *last = end;
+  // median of 3 guarantees an element >= pivot, the left scan is unguarded
+  while (cmp(*++first, pivot))
+    ;
+  if (first - 1 == begin) {
+    while (first < last && !cmp(*--last, pivot))
+      ;
+  } else {
+    while (!cmp(*--last, pivot))
+      ;
+  }
+  bool already = first >= last;
+  while (first < last) {
+    std::swap(*first, *last);
+    while (cmp(*++first, pivot))
+      ;
+    while (!cmp(*--last, pivot))
+      ;
+  }
+  auto *pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return {pivot_pos, already};
+}
+
+// move the num pairs (first + left[i], last - 1 - right[i]) across
+template <typename T>
+FORCE_INLINE constexpr void swap_offsets(T *first, T *last,
+                                         const uint8_t *left,
+                                         const uint8_t *right, size_t num,
+                                         bool use_swaps) noexcept {
+  if (use_swaps) {
+    // needed on descending inputs, keeps equal runs from degrading
+    for (size_t i = 0; i < num; ++i) {
+      std::swap(*(first + left[i]), *(last - 1 - right[i]));
+    }
+  } else if (num > 0) {
+    // one cyclic permutation, 2 moves per pair instead of 3
+    auto *l = first + left[0];
+    auto *r = last - 1 - right[0];
+    T tmp(std::move(*l));
+    *l = std::move(*r);
+    for (size_t i = 1; i < num; ++i) {
+      l = first + left[i];
+      *r = std::move(*l);
+      r = last - 1 - right[i];
+      *l = std::move(*r);
+    }
+    *r = std::move(tmp);
+  }
+}
+
+/**
+ * @brief partition_right with the element moves decoupled from the
+ * comparisons (BlockQuicksort), comparisons only feed offset counters
+ */
+template <typename T, typename Cmp>
+constexpr partition_t<T> partition_right_branchless(T *begin, T *end,
+                                                    Cmp &cmp) noexcept {
+  T pivot = std::move(*begin);
+  auto *first = begin;
+  auto *last = end;
+  while (cmp(*++first, pivot))
+    ;
+  if (first - 1 == begin) {
+    while (first < last && !cmp(*--last, pivot))
+      ;
+  } else {
+    while (!cmp(*--last, pivot))
+      ;
+  }
+  bool already = first >= last;
+  if (!already) {
+    // *last now belongs right, the unknown range is [first, last)
+    std::swap(*first, *last);
+    ++first;
+
+    uint8_t left[SORT_BLOCK] = {};
+    uint8_t right[SORT_BLOCK] = {};
+    size_t num_l = 0;
+    size_t num_r = 0;
+    size_t start_l = 0;
+    size_t start_r = 0;
+    auto fill_left = [&](size_t len) {
+      start_l = 0;
+      for (size_t i = 0; i < len; ++i) {
+        left[num_l] = (uint8_t)i;
+        num_l += !cmp(first[i], pivot);
+      }
+    };
+    auto fill_right = [&](size_t len) {
+      start_r = 0;
+      for (size_t i = 0; i < len; ++i) {
+        right[num_r] = (uint8_t)i;
+        num_r += cmp(*(last - 1 - i), pivot);
+      }
+    };
+    auto exchange = [&]() {
+      auto num = num_l < num_r ? num_l : num_r;
+      swap_offsets(first, last, left + start_l, right + start_r, num,
+                   num_l == num_r);
+      num_l -= num;
+      num_r -= num;
+      start_l += num;
+      start_r += num;
+    };
+
+    while (last - first > (ptrdiff_t)(2 * SORT_BLOCK)) {
+      if (num_l == 0) {
+        fill_left(SORT_BLOCK);
+      }
+      if (num_r == 0) {
+        fill_right(SORT_BLOCK);
+      }
+      exchange();
+      if (num_l == 0) {
+        first += SORT_BLOCK;
+      }
+      if (num_r == 0) {
+        last -= SORT_BLOCK;
+      }
+    }
+
+    // at most 2 blocks left, one of them may be partially consumed
+    auto unknown = (size_t)(last - first) - (num_l || num_r ? SORT_BLOCK : 0);
+    size_t l_size = 0;
+    size_t r_size = 0;
+    if (num_r != 0) {
+      l_size = unknown;
+      r_size = SORT_BLOCK;
+    } else if (num_l != 0) {
+      l_size = SORT_BLOCK;
+      r_size = unknown;
+    } else {
+      l_size = unknown / 2;
+      r_size = unknown - l_size;
+    }
+    if (unknown != 0 && num_l == 0) {
+      fill_left(l_size);
+    }
+    if (unknown != 0 && num_r == 0) {
+      fill_right(r_size);
+    }
+    exchange();
+    if (num_l == 0) {
+      first += l_size;
+    }
+    if (num_r == 0) {
+      last -= r_size;
+    }
+
+    // the side with offsets left swaps them past the other side
+    if (num_l != 0) {
+      while (num_l-- > 0) {
+        std::swap(*(first + left[start_l + num_l]), *--last);
+      }
+      first = last;
+    }
+    if (num_r != 0) {
+      while (num_r-- > 0) {
+        std::swap(*(last - 1 - right[start_r + num_r]), *first);
+        ++first;
+      }
+      last = first;
+    }
+  }
+  auto *pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return {pivot_pos, already};
+}
+
+/**
+ * @brief partition around *first, equal elements go left, used when the
+ * pivot equals the element before the range, the left part is then all
+ * equal and needs no further sorting
+ */
+template <typename T, typename Cmp>
+constexpr T *partition_left(T *begin, T *end, Cmp &cmp) noexcept {
+  T pivot = std::move(*begin);
+  auto *first = begin;
+  auto *last = end;
+  while (cmp(pivot, *--last))
+    ;
+  if (last + 1 == end) {
+    while (first < last && !cmp(pivot, *++first))
+      ;
+  } else {
+    while (!cmp(pivot, *++first))
+      ;
+  }
+  while (first < last) {
+    std::swap(*first, *last);
+    while (cmp(pivot, *--last))
+      ;
+    while (!cmp(pivot, *++first))
+      ;
+  }
+  *begin = std::move(*last);
+  *last = std::move(pivot);
+  return last;
+}
+
+template <bool Branchless, typename T, typename Cmp>
+constexpr void pdqsort_loop(T *begin, T *end, Cmp &cmp, int bad_allowed,
+                            bool leftmost) noexcept {
+  while (true) {
+    auto size = (size_t)(end - begin);
+    if (size < SORT_INSERTION) {
+      if (leftmost) {
+        insertion_sort(begin, end, cmp);
+      } else {
+        unguarded_insertion_sort(begin, end, cmp);
+      }
+      return;
+    }
+
+    // pivot ends up in *begin
+    auto half = size / 2;
+    if (size > SORT_NINTHER) {
+      sort3(begin, begin + half, end - 1, cmp);
+      sort3(begin + 1, begin + (half - 1), end - 2, cmp);
+      sort3(begin + 2, begin + (half + 1), end - 3, cmp);
+      sort3(begin + (half - 1), begin + half, begin + (half + 1), cmp);
+      std::swap(*begin, *(begin + half));
+    } else {
+      sort3(begin + half, begin, end - 1, cmp);
+    }
+
+    // pivot equal to the left neighbour, every element equal to it goes
+    // left and is done, many duplicates sort in linear time
+    if (!leftmost && !cmp(*(begin - 1), *begin)) {
+      begin = partition_left(begin, end, cmp) + 1;
+      continue;
+    }
+
+    auto [pivot, already] = Branchless
+                                ? partition_right_branchless(begin, end, cmp)
+                                : partition_right(begin, end, cmp);
+
+    auto l_size = (size_t)(pivot - begin);
+    auto r_size = (size_t)(end - (pivot + 1));
+    if (l_size < size / 8 || r_size < size / 8) {
+      if (--bad_allowed == 0) {
+        heap_sort(begin, end, cmp);
+        return;
+      }
+      // break patterns that keep choosing bad pivots
+      if (l_size >= SORT_INSERTION) {
+        std::swap(*begin, *(begin + l_size / 4));
+        std::swap(*(pivot - 1), *(pivot - l_size / 4));
+        if (l_size > SORT_NINTHER) {
+          std::swap(*(begin + 1), *(begin + (l_size / 4 + 1)));
+          std::swap(*(begin + 2), *(begin + (l_size / 4 + 2)));
+          std::swap(*(pivot - 2), *(pivot - (l_size / 4 + 1)));
+          std::swap(*(pivot - 3), *(pivot - (l_size / 4 + 2)));
+        }
+      }
+      if (r_size >= SORT_INSERTION) {
+        std::swap(*(pivot + 1), *(pivot + (1 + r_size / 4)));
+        std::swap(*(end - 1), *(end - r_size / 4));
+        if (r_size > SORT_NINTHER) {
+          std::swap(*(pivot + 2), *(pivot + (2 + r_size / 4)));
+          std::swap(*(pivot + 3), *(pivot + (3 + r_size / 4)));
+          std::swap(*(end - 2), *(end - (1 + r_size / 4)));
+          std::swap(*(end - 3), *(end - (2 + r_size / 4)));
+        }
+      }
+    } else if (already && partial_insertion_sort(begin, pivot, cmp) &&
+               partial_insertion_sort(pivot + 1, end, cmp)) {
+      // a balanced partition that moved nothing, likely already sorted
+      return;
+    }
+
+    // recurse into the left, loop on the right
+    pdqsort_loop<Branchless>(begin, pivot, cmp, bad_allowed, leftmost);
+    begin = pivot + 1;
+    leftmost = false;
+  }
+}
+
+/**
+ * @brief sort [first, last) by cmp, not stable
+ * @param cmp strict weak ordering, cmp(a, b) is a < b
+ */
+template <typename T, typename Cmp = sort_less_t>
+constexpr void sort(T *first, T *last, Cmp cmp = {}) noexcept {
+  if (last - first < 2) {
+    return;
+  }
+  constexpr bool branchless = std::is_arithmetic_v<T> || std::is_pointer_v<T>;
+  pdqsort_loop<branchless>(first, last, cmp,
+                           log2_floor((size_t)(last - first)), true);
+}
+
+template <sort_range R, typename Cmp = sort_less_t>
+constexpr void sort(R &&range, Cmp cmp = {}) noexcept {
+  sort(range.data(), range.data() + range.size(), std::move(cmp));
+}
+
+/**
+ * @brief stable LSD radix sort of [data, data + len) by key
+ * @param scratch len elements, contents are clobbered
+ * @param key maps an element to an unsigned integer
+ */
+template <typename T, typename Key = sort_identity_t>
+  requires std::unsigned_integral<
+      std::remove_cvref_t<std::invoke_result_t<Key &, const T &>>>
+void radix_sort(T *data, T *scratch, size_t len, Key key = {}) noexcept {
+  using key_type = std::remove_cvref_t<std::invoke_result_t<Key &, const T &>>;
+  if (len < 2) {
+    return;
+  }
+  T *src = data;
+  T *dst = scratch;
+  for (unsigned shift = 0; shift < sizeof(key_type) * 8; shift += 8) {
+    size_t count[256] = {};
+    for (size_t i = 0; i < len; ++i) {
+      ++count[(size_t)(key(src[i]) >> shift) & 0xff];
+    }
+    // every key has the same digit, the pass would only copy
+    if (count[(size_t)(key(src[0]) >> shift) & 0xff] == len) {
+      continue;
+    }
+    size_t pos = 0;
+    for (auto &cnt : count) {
+      auto tmp = cnt;
+      cnt = pos;
+      pos += tmp;
+    }
+    for (size_t i = 0; i < len; ++i) {
+      dst[count[(size_t)(key(src[i]) >> shift) & 0xff]++] = std::move(src[i]);
+    }
+    std::swap(src, dst);
+  }
+  if (src != data) {
+    for (size_t i = 0; i < len; ++i) {
+      data[i] = std::move(src[i]);
+    }
+  }
+}
+
+/**
+ * @brief radix sort over a range
+ * @param scratch at least data.size() elements
+ * @return false if scratch is too small, nothing is sorted
+ */
+template <sort_range R, sort_range S, typename Key = sort_identity_t>
+bool radix_sort(R &&data, S &&scratch, Key key = {}) noexcept {
+  if (scratch.size() < data.size()) {
+    return false;
+  }
+  radix_sort(data.data(), scratch.data(), data.size(), std::move(key));
+  return true;
+}
+
+}  // namespace bsl
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <config.h>
+
+#include <span>
+
+namespace bsl {
+
+template <typename T, size_t N = std::dynamic_extent>
+using span_t = std::span<T, N>;
+
+}  // namespace bsl
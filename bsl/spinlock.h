@@ -0,0 +1,239 @@
+#pragma once
+
+/*
+Spinlocks
+ticket_lock_t: FIFO, a next ticket and a now serving counter, two adjacent
+atomics on one cache line, waiters back off in proportion to their distance
+from the head of the queue
+mcs_lock_t: FIFO queue lock, every waiter spins on its own cache line
+(mcs_node_t), so handoff touches a single remote line regardless of the
+number of waiters, the node must stay alive until unlock
+rw_lock_t: reader-writer lock with writer preference, new readers wait
+while a writer is waiting
+
+All locks are zero initialized and take the backoff policy of cpu.h
+*/
+
+#include <bsl/cpu.h>
+#include <config.h>
+
+#include <atomic>
+
+namespace bsl {
+
+template <typename Backoff = backoff_t<>>
+class ticket_lock_t {
+  std::atomic<uint32_t> next{0};
+  std::atomic<uint32_t> owner{0};
+
+ public:
+  ticket_lock_t() noexcept = default;
+  ticket_lock_t(const ticket_lock_t &) = delete;
+  ticket_lock_t &operator=(const ticket_lock_t &) = delete;
+
+  void lock() noexcept {
+    auto ticket = next.fetch_add(1, std::memory_order_relaxed);
+    Backoff backoff;
+    while (true) {
+      auto cur = owner.load(std::memory_order_acquire);
+      if (cur == ticket) {
+        return;
+      }
+      backoff.pause_for(ticket - cur);
+    }
+  }
+
+  bool try_lock() noexcept {
+    auto cur = owner.load(std::memory_order_relaxed);
+    auto ticket = cur;
+    return next.compare_exchange_strong(ticket, cur + 1,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed);
+  }
+
+  void unlock() noexcept {
+    owner.store(owner.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  [[nodiscard]] bool is_locked() const noexcept {
+    return next.load(std::memory_order_relaxed) !=
+           owner.load(std::memory_order_relaxed);
+  }
+};
+
+// per-waiter queue node of mcs_lock_t
+struct CL_ALIGN mcs_node_t {
+  std::atomic<mcs_node_t *> next{nullptr};
+  std::atomic<bool> locked{false};
+};
+
+template <typename Backoff = no_backoff_t>
+class mcs_lock_t {
+  std::atomic<mcs_node_t *> tail{nullptr};
+
+ public:
+  mcs_lock_t() noexcept = default;
+  mcs_lock_t(const mcs_lock_t &) = delete;
+  mcs_lock_t &operator=(const mcs_lock_t &) = delete;
+
+  /**
+   * @brief acquire, spinning on node only
+   * @param node queue node owned by the caller until unlock
+   */
+  void lock(mcs_node_t &node) noexcept {
+    node.next.store(nullptr, std::memory_order_relaxed);
+    node.locked.store(true, std::memory_order_relaxed);
+    auto *prev = tail.exchange(&node, std::memory_order_acq_rel);
+    if (prev == nullptr) {
+      return;
+    }
+    prev->next.store(&node, std::memory_order_release);
+    Backoff backoff;
+    while (node.locked.load(std::memory_order_acquire)) {
+      backoff.pause();
+    }
+  }
+
+  bool try_lock(mcs_node_t &node) noexcept {
+    node.next.store(nullptr, std::memory_order_relaxed);
+    mcs_node_t *expected = nullptr;
+    return tail.compare_exchange_strong(expected, &node,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief release and hand off to the next waiter
+   * @param node node passed to lock
+   */
+  void unlock(mcs_node_t &node) noexcept {
+    auto *next = node.next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      auto *expected = &node;
+      if (tail.compare_exchange_strong(expected, nullptr,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+        return;
+      }
+      // a waiter swapped tail but has not linked itself yet
+      while ((next = node.next.load(std::memory_order_acquire)) == nullptr) {
+        cpu_relax();
+      }
+    }
+    next->locked.store(false, std::memory_order_release);
+  }
+
+  [[nodiscard]] bool is_locked() const noexcept {
+    return tail.load(std::memory_order_relaxed) != nullptr;
+  }
+};
+
+template <typename Backoff = backoff_t<>>
+class rw_lock_t {
+  // bit 0 writer holds, bits 1..15 waiting writers, bits 16..31 readers
+  static constexpr uint32_t WRITER = 1U;
+  static constexpr uint32_t WAITER = 1U << 1U;
+  static constexpr uint32_t WAITER_MASK = 0xFFFEU;
+  static constexpr uint32_t READER = 1U << 16U;
+  static constexpr uint32_t READER_MASK = 0xFFFF0000U;
+
+  std::atomic<uint32_t> state{0};
+
+ public:
+  rw_lock_t() noexcept = default;
+  rw_lock_t(const rw_lock_t &) = delete;
+  rw_lock_t &operator=(const rw_lock_t &) = delete;
+
+  void lock() noexcept {
+    state.fetch_add(WAITER, std::memory_order_relaxed);
+    Backoff backoff;
+    while (true) {
+      auto cur = state.load(std::memory_order_relaxed);
+      if ((cur & (WRITER | READER_MASK)) == 0 &&
+          state.compare_exchange_weak(cur, cur - WAITER + WRITER,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+        return;
+      }
+      backoff.pause();
+    }
+  }
+
+  bool try_lock() noexcept {
+    auto cur = state.load(std::memory_order_relaxed);
+    return (cur & (WRITER | READER_MASK)) == 0 &&
+           state.compare_exchange_strong(cur, cur + WRITER,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed);
+  }
+
+  void unlock() noexcept {
+    state.fetch_sub(WRITER, std::memory_order_release);
+  }
+
+  void lock_shared() noexcept {
+    Backoff backoff;
+    while (true) {
+      auto cur = state.load(std::memory_order_relaxed);
+      if ((cur & (WRITER | WAITER_MASK)) == 0 &&
+          state.compare_exchange_weak(cur, cur + READER,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+        return;
+      }
+      backoff.pause();
+    }
+  }
+
+  bool try_lock_shared() noexcept {
+    auto cur = state.load(std::memory_order_relaxed);
+    return (cur & (WRITER | WAITER_MASK)) == 0 &&
+           state.compare_exchange_strong(cur, cur + READER,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed);
+  }
+
+  void unlock_shared() noexcept {
+    state.fetch_sub(READER, std::memory_order_release);
+  }
+};
+
+// RAII guards
+
+template <typename Lock>
+class lock_guard_t {
+  Lock &lk;
+
+ public:
+  explicit lock_guard_t(Lock &lk) noexcept : lk(lk) { lk.lock(); }
+  lock_guard_t(const lock_guard_t &) = delete;
+  lock_guard_t &operator=(const lock_guard_t &) = delete;
+  ~lock_guard_t() noexcept { lk.unlock(); }
+};
+
+template <typename Lock>
+class shared_guard_t {
+  Lock &lk;
+
+ public:
+  explicit shared_guard_t(Lock &lk) noexcept : lk(lk) { lk.lock_shared(); }
+  shared_guard_t(const shared_guard_t &) = delete;
+  shared_guard_t &operator=(const shared_guard_t &) = delete;
+  ~shared_guard_t() noexcept { lk.unlock_shared(); }
+};
+
+// holds the queue node on the guard's stack frame
+template <typename Lock>
+class mcs_guard_t {
+  Lock &lk;
+  mcs_node_t node;
+
+ public:
+  explicit mcs_guard_t(Lock &lk) noexcept : lk(lk) { lk.lock(node); }
+  mcs_guard_t(const mcs_guard_t &) = delete;
+  mcs_guard_t &operator=(const mcs_guard_t &) = delete;
+  ~mcs_guard_t() noexcept { lk.unlock(node); }
+};
+
+}  // namespace bsl
@@ -1,49 +1,250 @@
 #pragma once
 
+#include <bsl/relocate.h>
 #include <config.h>
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
 #include <new>
+#include <type_traits>
 #include <utility>
 
 namespace bsl {
 
+// fixed capacity vector over uninitialized inline storage
+// elements are constructed on insertion only, so construction is free
+// and T needs not be default constructible, insertion into a full vector
+// fails and is reported by the return value
 template <typename T, size_t _capacity>
 class static_vec {
+ public:
+  using type = static_vec<T, _capacity>;
+  using value_type = T;
+  using iterator = T *;
+  using const_iterator = const T *;
+
  private:
   uint64_t _size = 0;
-  T _data[_capacity] = {};
+  alignas(T) unsigned char _data[_capacity * sizeof(T)];
+
+  T *ptr() noexcept { return std::launder(reinterpret_cast<T *>(_data)); }
+  [[nodiscard]] const T *ptr() const noexcept {
+    return std::launder(reinterpret_cast<const T *>(_data));
+  }
+
+  // open a gap of count slots at pos, slots are left uninitialized
+  T *open_gap(const T *pos, uint64_t count) noexcept {
+    auto *gap = ptr() + (pos - ptr());
+    relocate(gap + count, gap, (uint64_t)(end() - gap));
+    _size += count;
+    return gap;
+  }
 
  public:
+  static_vec() noexcept = default;
+  static_vec(const type &other) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    assign(other.begin(), other.end());
+  }
+  static_vec(type &&other) noexcept {
+    relocate(ptr(), other.ptr(), other._size);
+    _size = std::exchange(other._size, 0);
+  }
+  type &operator=(const type &other) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    if (this != &other) {
+      assign(other.begin(), other.end());
+    }
+    return *this;
+  }
+  type &operator=(type &&other) noexcept {
+    if (this != &other) {
+      clear();
+      relocate(ptr(), other.ptr(), other._size);
+      _size = std::exchange(other._size, 0);
+    }
+    return *this;
+  }
+  ~static_vec() noexcept
+    requires std::is_trivially_destructible_v<T>
+  = default;
+  ~static_vec() noexcept { clear(); }
 
-  // push back forward argument to data
+  /**
+   * @brief construct element at the back
+   * @param args arguments forwards to value constructor
+   * @return pointer to the new element, nullptr if full
+   */
   template <typename... Args>
-  void push_back(Args &&...args) {
-    if (_size < _capacity) {
-      new (_data + _size) T(std::forward<Args>(args)...);
-      _size++;
+  T *emplace_back(Args &&...args) noexcept(
+      std::is_nothrow_constructible_v<T, Args...>) {
+    if (_size == _capacity) [[unlikely]] {
+      return nullptr;
     }
+    auto *elem = new (ptr() + _size) T(std::forward<Args>(args)...);
+    _size++;
+    return elem;
+  }
+
+  // push back forward argument to data, false if full
+  template <typename... Args>
+  bool push_back(Args &&...args) noexcept(
+      std::is_nothrow_constructible_v<T, Args...>) {
+    return emplace_back(std::forward<Args>(args)...) != nullptr;
   }
-  void pop_back() {
+  void pop_back() noexcept {
     _size--;
-    _data[_size].~T();
+    ptr()[_size].~T();
+  }
+
+  /**
+   * @brief construct element before pos
+   * @param pos insert position, in [begin(), end()]
+   * @param args arguments forwards to value constructor, may refer to an
+   * element of this vector
+   * @return pointer to the new element, nullptr if full
+   */
+  template <typename... Args>
+  T *emplace(const T *pos, Args &&...args) noexcept(
+      std::is_nothrow_constructible_v<T, Args...>) {
+    if (_size == _capacity) [[unlikely]] {
+      return nullptr;
+    }
+    if (pos == end()) {
+      return emplace_back(std::forward<Args>(args)...);
+    }
+    // the gap would move the elements args refer to
+    T tmp(std::forward<Args>(args)...);
+    return new (open_gap(pos, 1)) T(std::move(tmp));
+  }
+  T *insert(const T *pos, const T &val) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    return emplace(pos, val);
+  }
+  T *insert(const T *pos, T &&val) noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    return emplace(pos, std::move(val));
   }
+
+  /**
+   * @brief insert count copies of val before pos, val may be an element of
+   * this vector
+   * @return pointer to the first inserted element, nullptr if it won't fit
+   */
+  T *insert(const T *pos, uint64_t count, const T &val) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    if (count > _capacity - _size) [[unlikely]] {
+      return nullptr;
+    }
+    T tmp(val);
+    auto *gap = open_gap(pos, count);
+    std::uninitialized_fill_n(gap, count, tmp);
+    return gap;
+  }
+
+  /**
+   * @brief insert [first, last) before pos, the range must not refer to
+   * this vector
+   * @return pointer to the first inserted element, nullptr if it won't fit
+   */
+  template <std::forward_iterator Itr>
+  T *insert(const T *pos, Itr first, Itr last) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    auto count = (uint64_t)std::distance(first, last);
+    if (count > _capacity - _size) [[unlikely]] {
+      return nullptr;
+    }
+    auto *gap = open_gap(pos, count);
+    std::uninitialized_copy(first, last, gap);
+    return gap;
+  }
+
+  /**
+   * @brief erase [first, last)
+   * @return pointer to the element after the erased range
+   */
+  T *erase(const T *first, const T *last) noexcept {
+    auto *dst = ptr() + (first - ptr());
+    auto *src = ptr() + (last - ptr());
+    auto count = (uint64_t)(src - dst);
+    destroy_n(dst, count);
+    relocate(dst, src, (uint64_t)(end() - src));
+    _size -= count;
+    return dst;
+  }
+  T *erase(const T *pos) noexcept { return erase(pos, pos + 1); }
+
+  /**
+   * @brief resize, new elements are value initialized or copied from val
+   * @return false if count exceeds capacity
+   */
+  bool resize(uint64_t count) noexcept(
+      std::is_nothrow_default_constructible_v<T>) {
+    if (count > _capacity) [[unlikely]] {
+      return false;
+    }
+    if (count < _size) {
+      destroy_n(ptr() + count, _size - count);
+    } else {
+      std::uninitialized_value_construct_n(ptr() + _size, count - _size);
+    }
+    _size = count;
+    return true;
+  }
+  bool resize(uint64_t count, const T &val) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    if (count > _capacity) [[unlikely]] {
+      return false;
+    }
+    if (count < _size) {
+      destroy_n(ptr() + count, _size - count);
+    } else {
+      std::uninitialized_fill_n(ptr() + _size, count - _size, val);
+    }
+    _size = count;
+    return true;
+  }
+
+  /**
+   * @brief replace contents
+   * @return false if it won't fit, vector is left empty
+   */
+  bool assign(uint64_t count, const T &val) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    clear();
+    return resize(count, val);
+  }
+  template <std::forward_iterator Itr>
+  bool assign(Itr first, Itr last) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    clear();
+    return insert(begin(), first, last) != nullptr;
+  }
+
+  void clear() noexcept {
+    destroy_n(ptr(), _size);
+    _size = 0;
+  }
+
   [[nodiscard]] uint64_t size() const { return _size; }
   [[nodiscard]] uint64_t capacity() const { return _capacity; }
   [[nodiscard]] bool empty() const { return _size == 0; }
+  [[nodiscard]] bool full() const { return _size == _capacity; }
+
+  T &operator[](uint64_t idx) { return ptr()[idx]; }
+  T &back() { return ptr()[_size - 1]; }
+  T &front() { return ptr()[0]; }
+  T *data() { return ptr(); }
+  T *begin() { return ptr(); }
+  T *end() { return ptr() + _size; }
 
-  T &operator[](uint64_t idx) { return _data[idx]; }
-  T &back() { return _data[_size - 1]; }
-  T &front() { return _data[0]; }
-  T *data() { return _data; }
-  T *begin() { return _data; }
-  T *end() { return _data + _size; }
-
-  const T &operator[](uint64_t idx) const { return _data[idx]; }
-  [[nodiscard]] const T &back() const { return _data[_size - 1]; }
-  [[nodiscard]] const T &front() const { return _data[0]; }
-  [[nodiscard]] const T *data() const { return _data; }
-  [[nodiscard]] const T *begin() const { return _data; }
-  [[nodiscard]] const T *end() const { return _data + _size; }
+  const T &operator[](uint64_t idx) const { return ptr()[idx]; }
+  [[nodiscard]] const T &back() const { return ptr()[_size - 1]; }
+  [[nodiscard]] const T &front() const { return ptr()[0]; }
+  [[nodiscard]] const T *data() const { return ptr(); }
+  [[nodiscard]] const T *begin() const { return ptr(); }
+  [[nodiscard]] const T *end() const { return ptr() + _size; }
 };
 
-}  // namespace bsl
\ No newline at end of file
+}  // namespace bsl
@@ -1,10 +1,306 @@
 #pragma once
 
+#include <bsl/alloc.h>
+#include <bsl/cstring.h>
+#include <bsl/string_view.h>
 #include <config.h>
-#include <string>
+
+#include <algorithm>
+#include <utility>
 
 namespace bsl {
 
-using string_t = std::string;
+// fixed capacity string with inline storage, never allocates
+// trivially copyable, always nul terminated, writes past capacity truncate
+template <size_t N>
+class static_string {
+  static_assert(N > 0 && N < 256, "length is stored in a single byte");
+
+ public:
+  using type = static_string<N>;
+  using value_type = char;
+
+ private:
+  char _data[N + 1] = {};
+  uint8_t _size = 0;
+
+ public:
+  constexpr static_string() noexcept = default;
+  constexpr static_string(sv_t sv) noexcept { append(sv); }
+  constexpr static_string(const char *str) noexcept : static_string(sv_t(str)) {}
+
+  /**
+   * @brief append string, truncate at capacity
+   * @param sv string to append
+   * @return true if all of sv fits
+   */
+  constexpr bool append(sv_t sv) noexcept {
+    auto len = std::min(sv.size(), N - _size);
+    std::copy_n(sv.data(), len, _data + _size);
+    _size = (uint8_t)(_size + len);
+    _data[_size] = '\0';
+    return len == sv.size();
+  }
+
+  /**
+   * @brief append character
+   * @param ch character
+   * @return false if full
+   */
+  constexpr bool push_back(char ch) noexcept {
+    if (_size == N) [[unlikely]] {
+      return false;
+    }
+    _data[_size++] = ch;
+    _data[_size] = '\0';
+    return true;
+  }
+  constexpr void pop_back() noexcept { _data[--_size] = '\0'; }
+
+  constexpr bool assign(sv_t sv) noexcept {
+    clear();
+    return append(sv);
+  }
+  constexpr void clear() noexcept {
+    _size = 0;
+    _data[0] = '\0';
+  }
+  /**
+   * @brief resize, new characters are filled with ch
+   * @return false if count exceeds capacity
+   */
+  constexpr bool resize(size_t count, char ch = '\0') noexcept {
+    if (count > N) [[unlikely]] {
+      return false;
+    }
+    if (count > _size) {
+      std::fill(_data + _size, _data + count, ch);
+    }
+    _size = (uint8_t)count;
+    _data[_size] = '\0';
+    return true;
+  }
+
+  constexpr type &operator+=(sv_t sv) noexcept {
+    append(sv);
+    return *this;
+  }
+  constexpr type &operator+=(char ch) noexcept {
+    push_back(ch);
+    return *this;
+  }
+
+  [[nodiscard]] constexpr size_t size() const noexcept { return _size; }
+  [[nodiscard]] constexpr size_t capacity() const noexcept { return N; }
+  [[nodiscard]] constexpr bool empty() const noexcept { return _size == 0; }
+  [[nodiscard]] constexpr bool full() const noexcept { return _size == N; }
+
+  constexpr char &operator[](size_t idx) noexcept { return _data[idx]; }
+  constexpr const char &operator[](size_t idx) const noexcept {
+    return _data[idx];
+  }
+  constexpr char *data() noexcept { return _data; }
+  [[nodiscard]] constexpr const char *data() const noexcept { return _data; }
+  [[nodiscard]] constexpr const char *c_str() const noexcept { return _data; }
+  constexpr char *begin() noexcept { return _data; }
+  constexpr char *end() noexcept { return _data + _size; }
+  [[nodiscard]] constexpr const char *begin() const noexcept { return _data; }
+  [[nodiscard]] constexpr const char *end() const noexcept {
+    return _data + _size;
+  }
+
+  [[nodiscard]] constexpr sv_t sv() const noexcept { return {_data, _size}; }
+  constexpr operator sv_t() const noexcept { return sv(); }
+
+  friend constexpr bool operator==(const type &lhs, sv_t rhs) noexcept {
+    return lhs.sv() == rhs;
+  }
+};
+
+// string with N bytes of inline storage, spills to Alloc when it grows past
+// it, capacity grows geometrically, allocation failure truncates and is
+// reported by the return value, never by exception
+template <size_t N = 32, allocator Alloc = heap_alloc_t>
+class small_string {
+ public:
+  using type = small_string<N, Alloc>;
+  using value_type = char;
+  using allocator_type = Alloc;
+
+ private:
+  char *_data = _buf;
+  size_t _size = 0;
+  size_t _cap = N;
+  [[no_unique_address]] Alloc _alloc{};
+  char _buf[N + 1] = {};
+
+  void release() noexcept {
+    if (!is_inline()) {
+      _alloc.deallocate(_data, _cap + 1, 1);
+    }
+  }
+
+  // take other's contents, other is left empty and inline, the current
+  // buffer must already be released
+  void steal(type &other) noexcept {
+    if (other.is_inline()) {
+      bsl::memcpy(_buf, other._buf, other._size + 1);
+      _data = _buf;
+      _cap = N;
+    } else {
+      _data = std::exchange(other._data, other._buf);
+      _cap = std::exchange(other._cap, N);
+    }
+    _size = std::exchange(other._size, 0);
+    other._buf[0] = '\0';
+  }
+
+ public:
+  small_string() noexcept = default;
+  explicit small_string(Alloc alloc) noexcept : _alloc(std::move(alloc)) {}
+  small_string(sv_t sv, Alloc alloc = {}) noexcept : _alloc(std::move(alloc)) {
+    append(sv);
+  }
+  small_string(const char *str, Alloc alloc = {}) noexcept
+      : small_string(sv_t(str), std::move(alloc)) {}
+  small_string(const type &other) noexcept : _alloc(other._alloc) {
+    append(other.sv());
+  }
+  small_string(type &&other) noexcept : _alloc(std::move(other._alloc)) {
+    steal(other);
+  }
+  type &operator=(const type &other) noexcept {
+    if (this != &other) {
+      assign(other.sv());
+    }
+    return *this;
+  }
+  type &operator=(type &&other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    release();
+    // the buffer goes with its allocator, other keeps ours for later use
+    std::swap(_alloc, other._alloc);
+    steal(other);
+    return *this;
+  }
+  ~small_string() noexcept { release(); }
+
+  /**
+   * @brief make room for at least cap characters
+   * @param cap requested capacity, excluding the terminator
+   * @return false if allocation failed, string is unchanged
+   */
+  bool reserve(size_t cap) noexcept {
+    if (cap <= _cap) {
+      return true;
+    }
+    auto new_cap = std::max(cap, _cap * 2);
+    auto *ptr = (char *)_alloc.allocate(new_cap + 1, 1);
+    if (ptr == nullptr) [[unlikely]] {
+      return false;
+    }
+    bsl::memcpy(ptr, _data, _size + 1);
+    release();
+    _data = ptr;
+    _cap = new_cap;
+    return true;
+  }
+
+  /**
+   * @brief append string, grow if needed
+   * @param sv string to append
+   * @return false if allocation failed, as much as fits is appended
+   */
+  bool append(sv_t sv) noexcept {
+    if (sv.size() > _cap - _size) {
+      // sv may point into this string, copy it before the old buffer goes
+      auto new_cap = std::max(_size + sv.size(), _cap * 2);
+      auto *ptr = (char *)_alloc.allocate(new_cap + 1, 1);
+      if (ptr != nullptr) [[likely]] {
+        bsl::memcpy(ptr, _data, _size);
+        bsl::memcpy(ptr + _size, sv.data(), sv.size());
+        release();
+        _data = ptr;
+        _cap = new_cap;
+        _size += sv.size();
+        _data[_size] = '\0';
+        return true;
+      }
+    }
+    auto len = std::min(sv.size(), _cap - _size);
+    bsl::memcpy(_data + _size, sv.data(), len);
+    _size += len;
+    _data[_size] = '\0';
+    return len == sv.size();
+  }
+  bool push_back(char ch) noexcept {
+    if (_size == _cap && !reserve(_size + 1)) [[unlikely]] {
+      return false;
+    }
+    _data[_size++] = ch;
+    _data[_size] = '\0';
+    return true;
+  }
+  void pop_back() noexcept { _data[--_size] = '\0'; }
+
+  bool assign(sv_t sv) noexcept {
+    clear();
+    return append(sv);
+  }
+  void clear() noexcept {
+    _size = 0;
+    _data[0] = '\0';
+  }
+  /**
+   * @brief resize, new characters are filled with ch
+   * @return false if allocation failed, string is unchanged
+   */
+  bool resize(size_t count, char ch = '\0') noexcept {
+    if (!reserve(count)) [[unlikely]] {
+      return false;
+    }
+    if (count > _size) {
+      bsl::memset(_data + _size, ch, count - _size);
+    }
+    _size = count;
+    _data[_size] = '\0';
+    return true;
+  }
+
+  type &operator+=(sv_t sv) noexcept {
+    append(sv);
+    return *this;
+  }
+  type &operator+=(char ch) noexcept {
+    push_back(ch);
+    return *this;
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return _size; }
+  [[nodiscard]] size_t capacity() const noexcept { return _cap; }
+  [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+  [[nodiscard]] bool is_inline() const noexcept { return _data == _buf; }
+
+  char &operator[](size_t idx) noexcept { return _data[idx]; }
+  const char &operator[](size_t idx) const noexcept { return _data[idx]; }
+  char *data() noexcept { return _data; }
+  [[nodiscard]] const char *data() const noexcept { return _data; }
+  [[nodiscard]] const char *c_str() const noexcept { return _data; }
+  char *begin() noexcept { return _data; }
+  char *end() noexcept { return _data + _size; }
+  [[nodiscard]] const char *begin() const noexcept { return _data; }
+  [[nodiscard]] const char *end() const noexcept { return _data + _size; }
+
+  [[nodiscard]] sv_t sv() const noexcept { return {_data, _size}; }
+  operator sv_t() const noexcept { return sv(); }
+
+  friend bool operator==(const type &lhs, sv_t rhs) noexcept {
+    return lhs.sv() == rhs;
+  }
+};
+
+using string_t = small_string<>;
 
-} // namespace bsl
\ No newline at end of file
+}  // namespace bsl
@@ -0,0 +1,533 @@
+#pragma once
+
+/*
+Coroutine Tasks
+task<T> is a lazily started coroutine returning T, awaiting a task starts
+it and resumes the awaiter when it finishes (symmetric transfer, no stack
+growth through chains of awaits)
+
+Frames never come from the global heap, the frame is taken from the first
+parameter of a task coroutine if it is an allocator (e.g. an arena_t or
+pool_t), otherwise from the second, which covers member functions, whose
+object comes first, and equally free functions taking the allocator
+second, a coroutine with neither fails to compile, stateful
+allocators passed by reference must outlive the frame, copyable ones
+(alloc_ref_t) are copied into the frame, an allocation failure yields an
+invalid task instead of calling the coroutine
+
+  bsl::task<> rx(bsl::pool_t &pool, ring_t &ring) {
+    while (true) {
+      co_await bsl::ring_readable(ring);
+      ...
+    }
+  }
+  exec.spawn(rx(pool, ring));
+  exec.run();
+
+executor_t runs tasks on one core, a suspended task is parked on an
+intrusive cdll_t list through a node in its frame, so scheduling never
+allocates
+  ready    resumed in FIFO order, one round per run_once
+  waiting  polled conditions, ring readiness, MMIO bits, any predicate
+  timers   sorted by deadline, only the earliest ones are checked
+Deadlines are in the executor clock's ticks, rdcycle by default
+*/
+
+#include <bsl/align.h>
+#include <bsl/alloc.h>
+#include <bsl/cdll.h>
+#include <bsl/cpu.h>
+#include <bsl/in_place.h>
+#include <bsl/ring_buf.h>
+#include <config.h>
+
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace bsl {
+
+class executor_t;
+template <typename T>
+class task_promise_t;
+
+constexpr size_t FRAME_ALIGN = alignof(std::max_align_t);
+
+// placed after a coroutine frame, gives the frame back to its allocator
+struct frame_trailer_t {
+  void (*release)(frame_trailer_t *self, void *frame, size_t size) noexcept;
+};
+
+template <allocator Alloc>
+struct frame_trailer_impl_t : frame_trailer_t {
+  // copyable allocators are handles, others are referenced
+  static constexpr bool COPY = std::is_copy_constructible_v<Alloc>;
+  std::conditional_t<COPY, Alloc, Alloc *> alloc;
+
+  static void release_frame(frame_trailer_t *self, void *frame,
+                            size_t size) noexcept {
+    auto *trailer = static_cast<frame_trailer_impl_t *>(self);
+    auto total = p2align_up(size, FRAME_ALIGN) + sizeof(frame_trailer_impl_t);
+    if constexpr (COPY) {
+      // the allocator lives in the memory being freed
+      Alloc alloc = std::move(trailer->alloc);
+      trailer->~frame_trailer_impl_t();
+      alloc.deallocate(frame, total, FRAME_ALIGN);
+    } else {
+      trailer->alloc->deallocate(frame, total, FRAME_ALIGN);
+    }
+  }
+};
+
+template <allocator Alloc>
+void *frame_alloc(size_t size, Alloc &alloc) noexcept {
+  using trailer_t = frame_trailer_impl_t<Alloc>;
+  static_assert(alignof(trailer_t) <= FRAME_ALIGN);
+  auto off = p2align_up(size, FRAME_ALIGN);
+  auto *mem = alloc.allocate(off + sizeof(trailer_t), FRAME_ALIGN);
+  if (mem == nullptr) [[unlikely]] {
+    return nullptr;
+  }
+  auto *trailer = new ((char *)mem + off) trailer_t;
+  trailer->release = &trailer_t::release_frame;
+  if constexpr (trailer_t::COPY) {
+    new (&trailer->alloc) Alloc(alloc);
+  } else {
+    trailer->alloc = &alloc;
+  }
+  return mem;
+}
+
+// state every task frame carries for the executor
+class task_promise_base_t {
+  friend class executor_t;
+  template <typename T>
+  friend class task;
+
+ protected:
+  // first member, a list node converts back to its promise
+  cdlln_t<> link;
+  std::coroutine_handle<> self;
+  // awaiting task, resumed on completion
+  std::coroutine_handle<> cont;
+  executor_t *exec = nullptr;
+  // condition polled while on the waiting list
+  bool (*poll)(void *ctx) noexcept = nullptr;
+  void *poll_ctx = nullptr;
+  uint64_t deadline = 0;
+  // spawned, owned by the executor, frees itself on completion
+  bool detached = false;
+
+  struct final_awaiter_t {
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+    template <typename P>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<P> handle) noexcept;
+    void await_resume() const noexcept {}
+  };
+
+ public:
+  task_promise_base_t() noexcept = default;
+  task_promise_base_t(const task_promise_base_t &) = delete;
+  task_promise_base_t &operator=(const task_promise_base_t &) = delete;
+
+  [[nodiscard]] executor_t &executor() const noexcept { return *exec; }
+
+  static task_promise_base_t &from_link(cdlln_t<> *node) noexcept {
+    return *reinterpret_cast<task_promise_base_t *>(node);
+  }
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  final_awaiter_t final_suspend() const noexcept { return {}; }
+  // built without exceptions
+  void unhandled_exception() const noexcept { __builtin_trap(); }
+
+  template <allocator Alloc, typename... Args>
+  static void *operator new(size_t size, Alloc &alloc, Args &...) noexcept {
+    return frame_alloc(size, alloc);
+  }
+  // allocator second, after a non-allocator first parameter, the object of
+  // a member function coroutine or the first argument of a free one
+  template <typename Obj, allocator Alloc, typename... Args>
+    requires(!allocator<Obj>)
+  static void *operator new(size_t size, Obj &, Alloc &alloc,
+                            Args &...) noexcept {
+    return frame_alloc(size, alloc);
+  }
+  // no allocator parameter, refuse the global heap
+  static void *operator new(size_t size) = delete;
+  static void operator delete(void *ptr, size_t size) noexcept {
+    auto *trailer = reinterpret_cast<frame_trailer_t *>(
+        (char *)ptr + p2align_up(size, FRAME_ALIGN));
+    trailer->release(trailer, ptr, size);
+  }
+};
+
+template <typename P>
+concept task_promise = std::derived_from<P, task_promise_base_t>;
+
+/**
+ * @brief lazily started coroutine, owns its frame until spawned or done
+ * @tparam T result type
+ */
+template <typename T = void>
+class task {
+ public:
+  using promise_type = task_promise_t<T>;
+  using handle_type = std::coroutine_handle<promise_type>;
+
+ private:
+  handle_type handle;
+
+  struct awaiter_t {
+    handle_type handle;
+
+    [[nodiscard]] bool await_ready() const noexcept { return handle.done(); }
+    template <task_promise P>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<P> parent) noexcept {
+      auto &promise = handle.promise();
+      promise.cont = parent;
+      promise.exec = parent.promise().exec;
+      return handle;
+    }
+    T await_resume() noexcept {
+      if constexpr (!std::is_void_v<T>) {
+        return handle.promise().result();
+      }
+    }
+  };
+
+ public:
+  task() noexcept = default;
+  explicit task(handle_type handle) noexcept : handle(handle) {}
+  task(const task &) = delete;
+  task &operator=(const task &) = delete;
+  task(task &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+  task &operator=(task &&other) noexcept {
+    if (this != &other) {
+      if (handle) {
+        handle.destroy();
+      }
+      handle = std::exchange(other.handle, {});
+    }
+    return *this;
+  }
+  ~task() noexcept {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+
+  // false if the frame allocation failed
+  [[nodiscard]] bool valid() const noexcept { return (bool)handle; }
+  // an invalid task has nothing left to run and counts as done
+  [[nodiscard]] bool done() const noexcept { return !handle || handle.done(); }
+  [[nodiscard]] handle_type release() noexcept {
+    return std::exchange(handle, {});
+  }
+
+  // awaiting an invalid task traps, it has no result, check valid() first
+  auto operator co_await() && noexcept {
+    if (!handle) [[unlikely]] {
+      __builtin_trap();
+    }
+    return awaiter_t{handle};
+  }
+};
+
+template <typename T>
+class task_promise_t : public task_promise_base_t {
+  alignas(T) unsigned char storage[sizeof(T)];
+  bool has_value = false;
+
+ public:
+  task_promise_t() noexcept = default;
+  ~task_promise_t() noexcept {
+    if (has_value) {
+      std::launder(reinterpret_cast<T *>(storage))->~T();
+    }
+  }
+
+  task<T> get_return_object() noexcept {
+    auto handle = std::coroutine_handle<task_promise_t>::from_promise(*this);
+    self = handle;
+    return task<T>(handle);
+  }
+  static task<T> get_return_object_on_allocation_failure() noexcept {
+    return {};
+  }
+
+  template <typename U>
+    requires std::constructible_from<T, U &&>
+  void return_value(U &&val) noexcept {
+    new (storage) T(std::forward<U>(val));
+    has_value = true;
+  }
+  T result() noexcept {
+    return std::move(*std::launder(reinterpret_cast<T *>(storage)));
+  }
+};
+
+template <>
+class task_promise_t<void> : public task_promise_base_t {
+ public:
+  task<> get_return_object() noexcept {
+    auto handle = std::coroutine_handle<task_promise_t>::from_promise(*this);
+    self = handle;
+    return task<>(handle);
+  }
+  static task<> get_return_object_on_allocation_failure() noexcept {
+    return {};
+  }
+  void return_void() const noexcept {}
+};
+
+/**
+ * @brief single core run-queue executor
+ */
+class executor_t {
+  counted_cdll_t<> ready{in_place};
+  counted_cdll_t<> waiting{in_place};
+  counted_cdll_t<> timers{in_place};
+  uint64_t (*clock)() noexcept = rdcycle;
+  size_t live = 0;
+
+  template <typename T>
+  friend class task;
+  friend class task_promise_base_t;
+
+  void resume_all(counted_cdll_t<> &list) noexcept {
+    cdlln_t<> *node;
+    while ((node = list.pop_front()) != PTR_FAIL) {
+      task_promise_base_t::from_link(node).self.resume();
+    }
+  }
+
+ public:
+  executor_t() noexcept = default;
+  explicit executor_t(uint64_t (*clock)() noexcept) noexcept : clock(clock) {}
+  executor_t(const executor_t &) = delete;
+  executor_t(executor_t &&) = delete;
+  executor_t &operator=(const executor_t &) = delete;
+  executor_t &operator=(executor_t &&) = delete;
+
+  /**
+   * @brief hand a task to the executor, it is freed when it completes
+   * @return false if the task is invalid (frame allocation failed)
+   */
+  template <typename T>
+  bool spawn(task<T> &&work) noexcept {
+    if (!work.valid()) {
+      return false;
+    }
+    auto &promise = work.release().promise();
+    promise.exec = this;
+    promise.detached = true;
+    ++live;
+    schedule(promise);
+    return true;
+  }
+
+  // make a suspended task runnable
+  void schedule(task_promise_base_t &promise) noexcept {
+    ready.push_back(&promise.link);
+  }
+
+  // park a suspended task until poll(poll_ctx) holds
+  void wait(task_promise_base_t &promise, bool (*poll)(void *) noexcept,
+            void *poll_ctx) noexcept {
+    promise.poll = poll;
+    promise.poll_ctx = poll_ctx;
+    waiting.push_back(&promise.link);
+  }
+
+  // park a suspended task until the clock reaches deadline
+  void sleep(task_promise_base_t &promise, uint64_t deadline) noexcept {
+    promise.deadline = deadline;
+    // new deadlines are mostly the latest, search from the back
+    auto pos = timers.end();
+    for (auto itr = timers.rbegin(); itr != timers.rend(); ++itr) {
+      if (task_promise_base_t::from_link(itr).deadline <= deadline) {
+        break;
+      }
+      pos = counted_cdll_t<>::iterator(itr);
+    }
+    timers.insert(pos, &promise.link);
+  }
+
+  /**
+   * @brief one scheduling round, wake expired timers and satisfied polls,
+   * then resume every task that was ready at the start of the round
+   * @return false if no task ran
+   */
+  bool run_once() noexcept {
+    auto now = clock();
+    while (!timers.empty()) {
+      auto *node = timers.front();
+      if (task_promise_base_t::from_link(node).deadline > now) {
+        break;
+      }
+      timers.erase(node);
+      ready.push_back(node);
+    }
+    for (auto itr = waiting.begin(); itr != waiting.end();) {
+      auto &promise = task_promise_base_t::from_link(itr);
+      if (promise.poll(promise.poll_ctx)) {
+        itr = waiting.erase(&promise.link);
+        ready.push_back(&promise.link);
+      } else {
+        ++itr;
+      }
+    }
+    if (ready.empty()) {
+      return false;
+    }
+    // tasks made ready by this round run in the next one
+    counted_cdll_t<> round{in_place};
+    round.splice(round.end(), ready);
+    resume_all(round);
+    return true;
+  }
+
+  // run until every spawned task completed
+  void run() noexcept {
+    while (live != 0) {
+      if (!run_once()) {
+        cpu_relax();
+      }
+    }
+  }
+
+  [[nodiscard]] uint64_t now() const noexcept { return clock(); }
+  // spawned tasks not yet completed
+  [[nodiscard]] size_t tasks() const noexcept { return live; }
+  [[nodiscard]] size_t ready_count() const noexcept { return ready.size(); }
+  [[nodiscard]] size_t waiting_count() const noexcept {
+    return waiting.size() + timers.size();
+  }
+};
+
+template <typename P>
+std::coroutine_handle<> task_promise_base_t::final_awaiter_t::await_suspend(
+    std::coroutine_handle<P> handle) noexcept {
+  auto &promise = handle.promise();
+  if (promise.cont) {
+    return promise.cont;
+  }
+  if (promise.detached) {
+    // suspended at the final point, the frame may go
+    auto *exec = promise.exec;
+    handle.destroy();
+    --exec->live;
+  }
+  return std::noop_coroutine();
+}
+
+// reschedule behind every other ready task
+struct yield_t {
+  [[nodiscard]] bool await_ready() const noexcept { return false; }
+  template <task_promise P>
+  void await_suspend(std::coroutine_handle<P> handle) const noexcept {
+    handle.promise().executor().schedule(handle.promise());
+  }
+  void await_resume() const noexcept {}
+};
+inline yield_t yield() noexcept { return {}; }
+
+/**
+ * @brief suspend until pred() holds, checked once per executor round
+ * @param pred noexcept predicate, must stay valid while suspended
+ */
+template <typename Pred>
+class poll_until_t {
+  Pred pred;
+
+  static bool check(void *ctx) noexcept {
+    return static_cast<poll_until_t *>(ctx)->pred();
+  }
+
+ public:
+  explicit poll_until_t(Pred pred) noexcept : pred(std::move(pred)) {}
+
+  [[nodiscard]] bool await_ready() noexcept { return pred(); }
+  template <task_promise P>
+  void await_suspend(std::coroutine_handle<P> handle) noexcept {
+    handle.promise().executor().wait(handle.promise(), &check, this);
+  }
+  void await_resume() const noexcept {}
+};
+
+template <typename Pred>
+poll_until_t<Pred> poll_until(Pred pred) noexcept {
+  return poll_until_t<Pred>(std::move(pred));
+}
+
+// until at least n elements can be read, a hint with several readers
+template <typename Tp, uint64_t Sz>
+auto ring_readable(const ring_buf_t<Tp, Sz> &ring, uint64_t n = 1) noexcept {
+  return poll_until([&ring, n]() noexcept { return ring.read_avail() >= n; });
+}
+
+// until at least n elements can be written, a hint with several writers
+template <typename Tp, uint64_t Sz>
+auto ring_writable(const ring_buf_t<Tp, Sz> &ring, uint64_t n = 1) noexcept {
+  return poll_until([&ring, n]() noexcept { return ring.write_avail() >= n; });
+}
+
+// until (*reg & mask) == val, reg is read with a volatile load per round
+template <std::unsigned_integral T>
+auto mmio_poll(const volatile T *reg, T mask, T val) noexcept {
+  return poll_until([reg, mask, val]() noexcept {
+    return (T)(*reg & mask) == val;
+  });
+}
+
+// suspend until the executor clock reaches deadline
+class sleep_until_t {
+  uint64_t deadline;
+
+ public:
+  explicit sleep_until_t(uint64_t deadline) noexcept : deadline(deadline) {}
+
+  [[nodiscard]] bool await_ready() const noexcept { return false; }
+  template <task_promise P>
+  bool await_suspend(std::coroutine_handle<P> handle) const noexcept {
+    auto &exec = handle.promise().executor();
+    if (exec.now() >= deadline) {
+      return false;
+    }
+    exec.sleep(handle.promise(), deadline);
+    return true;
+  }
+  void await_resume() const noexcept {}
+};
+
+inline sleep_until_t sleep_until(uint64_t deadline) noexcept {
+  return sleep_until_t(deadline);
+}
+
+// suspend for ticks of the executor clock
+class sleep_for_t {
+  uint64_t ticks;
+
+ public:
+  explicit sleep_for_t(uint64_t ticks) noexcept : ticks(ticks) {}
+
+  [[nodiscard]] bool await_ready() const noexcept { return ticks == 0; }
+  template <task_promise P>
+  void await_suspend(std::coroutine_handle<P> handle) const noexcept {
+    auto &exec = handle.promise().executor();
+    exec.sleep(handle.promise(), exec.now() + ticks);
+  }
+  void await_resume() const noexcept {}
+};
+
+inline sleep_for_t sleep_for(uint64_t ticks) noexcept {
+  return sleep_for_t(ticks);
+}
+
+}  // namespace bsl
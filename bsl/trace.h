@@ -0,0 +1,327 @@
+#pragma once
+
+/*
+Binary Tracing
+Each CPU logs fixed-size records (timestamp, event id, up to TRACE_ARGS
+uint64_t arguments) into its own overwrite-on-full ring, logging is a
+counter increment and a few stores, no formatting, no locks
+
+Events are registered at compile time as a constexpr table, log<Id>()
+checks the id and the argument count against the format string
+
+  inline constexpr bsl::trace_event_t events[] = {
+      {"irq", "vector %u"},
+      {"switch", "prev %u next %u"},
+  };
+  constexpr auto EV_IRQ = bsl::trace_id(events, "irq");
+  bsl::trace_t<events, 1024, MAX_CPU, cpu_id_fn> trace;
+  trace.log<EV_IRQ>(vec);
+
+The trace memory is self describing, rings and the event table start with
+magic words on cache line boundaries, a host tool (tools/trace_decode.cpp)
+finds them in a raw memory dump and prints one time merged trace, a record
+being written while the dump is taken is detected and dropped, the dump is
+read with the byte order of the traced machine
+*/
+
+#include <bsl/charconv.h>
+#include <bsl/cpu.h>
+#include <bsl/percpu.h>
+#include <bsl/string_view.h>
+#include <config.h>
+
+#include <atomic>
+#include <concepts>
+#include <type_traits>
+#include <utility>
+
+namespace bsl {
+
+constexpr size_t TRACE_ARGS = 5;
+constexpr size_t TRACE_NAME_SZ = 32;
+constexpr size_t TRACE_FMT_SZ = 96;
+
+consteval uint64_t trace_magic(const char (&str)[9]) {
+  uint64_t ret = 0;
+  for (size_t i = 0; i < 8; ++i) {
+    ret |= (uint64_t)(uint8_t)str[i] << (i * 8);
+  }
+  return ret;
+}
+constexpr uint64_t TRACE_RING_MAGIC = trace_magic("BSLTRING");
+constexpr uint64_t TRACE_TABLE_MAGIC = trace_magic("BSLTEVNT");
+
+struct trace_event_t {
+  sv_t name;
+  sv_t fmt;
+};
+
+// number of arguments consumed by a format string, %% is a literal
+constexpr size_t trace_fmt_args(sv_t fmt) noexcept {
+  size_t ret = 0;
+  for (size_t i = 0; i + 1 < fmt.size(); ++i) {
+    if (fmt[i] == '%') {
+      ret += fmt[i + 1] != '%' ? 1 : 0;
+      ++i;
+    }
+  }
+  return ret;
+}
+
+/**
+ * @brief id of the event called name
+ * @return index in events, N if absent (rejected by log)
+ */
+template <size_t N>
+consteval uint32_t trace_id(const trace_event_t (&events)[N], sv_t name) {
+  for (size_t i = 0; i < N; ++i) {
+    if (events[i].name == name) {
+      return (uint32_t)i;
+    }
+  }
+  return (uint32_t)N;
+}
+
+// one cache line per record
+struct CL_ALIGN trace_rec_t {
+  uint64_t stamp;
+  // ring index + 1, 0 while the record is being written
+  uint64_t seq;
+  uint32_t event;
+  uint32_t nargs;
+  uint64_t args[TRACE_ARGS];
+};
+static_assert(sizeof(trace_rec_t) == CACHELINE_SZ);
+
+struct CL_ALIGN trace_ring_hdr_t {
+  uint64_t magic;
+  uint32_t cpu;
+  uint32_t nrec;
+  // records ever logged, the ring holds the last nrec of them
+  uint64_t head;
+};
+
+struct trace_desc_t {
+  char name[TRACE_NAME_SZ];
+  char fmt[TRACE_FMT_SZ];
+};
+
+struct CL_ALIGN trace_table_hdr_t {
+  uint64_t magic;
+  uint32_t count;
+};
+
+template <typename T>
+FORCE_INLINE uint64_t trace_arg(T val) noexcept {
+  if constexpr (std::is_pointer_v<T>) {
+    return (uint64_t)(uintptr_t)val;
+  } else {
+    static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+                  "trace arguments are integers, enums or pointers");
+    return (uint64_t)val;
+  }
+}
+
+// one CPU's ring, N records, power of 2
+template <size_t N>
+class trace_ring_t {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "ring size must be a power of 2");
+
+  trace_ring_hdr_t hdr{};
+  trace_rec_t recs[N]{};
+
+ public:
+  void init(uint32_t cpu) noexcept {
+    hdr.cpu = cpu;
+    hdr.nrec = N;
+    std::atomic_ref(hdr.head).store(0, std::memory_order_relaxed);
+    for (auto &rec : recs) {
+      std::atomic_ref(rec.seq).store(0, std::memory_order_relaxed);
+    }
+    std::atomic_ref(hdr.magic).store(TRACE_RING_MAGIC,
+                                     std::memory_order_release);
+  }
+
+  /**
+   * @brief append a record, overwrites the oldest one when full, safe
+   * against interrupts logging on the same CPU
+   */
+  template <typename... Args>
+  FORCE_INLINE void log(uint32_t event, Args... args) noexcept {
+    static_assert(sizeof...(Args) <= TRACE_ARGS, "too many trace arguments");
+    auto idx = std::atomic_ref(hdr.head).fetch_add(1, std::memory_order_relaxed);
+    auto &rec = recs[idx & (N - 1)];
+    std::atomic_ref(rec.seq).store(0, std::memory_order_relaxed);
+    // invalidate before the payload changes, a reader sees seq 0 or a stale
+    // seq and drops the record
+    std::atomic_thread_fence(std::memory_order_release);
+    rec.stamp = rdcycle();
+    rec.event = event;
+    rec.nargs = sizeof...(Args);
+    size_t i = 0;
+    ((rec.args[i++] = trace_arg(args)), ...);
+    std::atomic_ref(rec.seq).store(idx + 1, std::memory_order_release);
+  }
+};
+
+/**
+ * @brief per-CPU tracer with a compile time event table
+ * @tparam Events constexpr trace_event_t array
+ * @tparam N records per CPU, power of 2
+ */
+template <const auto &Events, size_t N, size_t MaxCpu, cpu_id_hook CpuId>
+class trace_t {
+  static constexpr size_t COUNT = std::extent_v<
+      std::remove_reference_t<decltype(Events)>>;
+
+  static consteval bool table_fits() {
+    for (const auto &ev : Events) {
+      if (ev.name.size() >= TRACE_NAME_SZ || ev.fmt.size() >= TRACE_FMT_SZ ||
+          trace_fmt_args(ev.fmt) > TRACE_ARGS) {
+        return false;
+      }
+    }
+    return true;
+  }
+  static_assert(table_fits(), "trace event name or format too long");
+
+  struct CL_ALIGN table_t {
+    trace_table_hdr_t hdr{};
+    trace_desc_t desc[COUNT]{};
+  };
+
+  table_t table;
+  percpu_t<trace_ring_t<N>, MaxCpu, CpuId> rings;
+
+ public:
+  trace_t() noexcept = default;
+  explicit trace_t(CpuId hook) noexcept : rings(std::move(hook)) {}
+  trace_t(const trace_t &) = delete;
+  trace_t &operator=(const trace_t &) = delete;
+
+  // write the event table and reset every ring
+  void init() noexcept {
+    for (size_t i = 0; i < COUNT; ++i) {
+      Events[i].name.copy(table.desc[i].name, TRACE_NAME_SZ - 1);
+      Events[i].fmt.copy(table.desc[i].fmt, TRACE_FMT_SZ - 1);
+    }
+    table.hdr.count = COUNT;
+    std::atomic_ref(table.hdr.magic)
+        .store(TRACE_TABLE_MAGIC, std::memory_order_release);
+    for (size_t cpu = 0; cpu < MaxCpu; ++cpu) {
+      rings[cpu].init((uint32_t)cpu);
+    }
+  }
+
+  // log on the current CPU
+  template <uint32_t Id, typename... Args>
+  FORCE_INLINE void log(Args... args) noexcept {
+    static_assert(Id < COUNT, "unregistered trace event");
+    static_assert(trace_fmt_args(Events[Id].fmt) == sizeof...(Args),
+                  "trace argument count does not match the format");
+    rings.local().log(Id, args...);
+  }
+
+  [[nodiscard]] trace_ring_t<N> &ring(size_t cpu) noexcept {
+    return rings[cpu];
+  }
+};
+
+// read side of a ring found in a memory dump
+class trace_ring_view_t {
+  const trace_ring_hdr_t *hdr = nullptr;
+  const trace_rec_t *recs = nullptr;
+
+ public:
+  trace_ring_view_t() noexcept = default;
+
+  /**
+   * @brief parse the ring at ptr
+   * @param ptr start of a ring header, cache line aligned
+   * @param len bytes available from ptr
+   * @return invalid view if ptr does not hold a complete ring
+   */
+  static trace_ring_view_t make(const void *ptr, size_t len) noexcept {
+    trace_ring_view_t ret;
+    const auto *hdr = reinterpret_cast<const trace_ring_hdr_t *>(ptr);
+    if (len < sizeof(trace_ring_hdr_t) || hdr->magic != TRACE_RING_MAGIC ||
+        hdr->nrec == 0 || (hdr->nrec & (hdr->nrec - 1)) != 0 ||
+        (len - sizeof(trace_ring_hdr_t)) / sizeof(trace_rec_t) < hdr->nrec) {
+      return ret;
+    }
+    ret.hdr = hdr;
+    ret.recs = reinterpret_cast<const trace_rec_t *>(hdr + 1);
+    return ret;
+  }
+
+  [[nodiscard]] bool valid() const noexcept { return hdr != nullptr; }
+  [[nodiscard]] uint32_t cpu() const noexcept { return hdr->cpu; }
+  // bytes covered by the ring
+  [[nodiscard]] size_t bytes() const noexcept {
+    return sizeof(trace_ring_hdr_t) + hdr->nrec * sizeof(trace_rec_t);
+  }
+  // index range [first(), last()) still held by the ring
+  [[nodiscard]] uint64_t last() const noexcept { return hdr->head; }
+  [[nodiscard]] uint64_t first() const noexcept {
+    return hdr->head > hdr->nrec ? hdr->head - hdr->nrec : 0;
+  }
+
+  /**
+   * @brief copy out the record with index idx, seq is checked again after
+   * the copy, so a record rewritten meanwhile is never returned half old
+   * @param out the record, meaningless on failure
+   * @return false if it was torn or already overwritten
+   */
+  bool at(uint64_t idx, trace_rec_t &out) const noexcept {
+    const auto &rec = recs[idx & (hdr->nrec - 1)];
+    auto &seq = const_cast<uint64_t &>(rec.seq);
+    if (std::atomic_ref(seq).load(std::memory_order_acquire) != idx + 1) {
+      return false;
+    }
+    out = rec;
+    // the copy completes before seq is read again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return std::atomic_ref(seq).load(std::memory_order_relaxed) == idx + 1 &&
+           out.nargs <= TRACE_ARGS;
+  }
+};
+
+/**
+ * @brief format a record's arguments, supports %u %d %x %p and %%
+ * @return bytes written, output is truncated to buf_len
+ */
+inline size_t trace_format(char *buf, size_t buf_len, sv_t fmt,
+                           const uint64_t *args, size_t nargs) noexcept {
+  size_t len = 0;
+  size_t arg = 0;
+  auto put = [&](char ch) {
+    if (len < buf_len) {
+      buf[len++] = ch;
+    }
+  };
+  for (size_t i = 0; i < fmt.size(); ++i) {
+    if (fmt[i] != '%' || i + 1 == fmt.size()) {
+      put(fmt[i]);
+      continue;
+    }
+    auto spec = fmt[++i];
+    if (spec == '%') {
+      put('%');
+      continue;
+    }
+    auto val = arg < nargs ? args[arg++] : 0;
+    if (spec == 'd' && (int64_t)val < 0) {
+      put('-');
+      val = 0 - val;
+    }
+    if (spec == 'p') {
+      put('0');
+      put('x');
+    }
+    len += to_chars(buf + len, buf_len - len, val,
+                    spec == 'x' || spec == 'p' ? 16 : 10);
+  }
+  return len;
+}
+
+}  // namespace bsl
@@ -0,0 +1,217 @@
+#pragma once
+
+/*
+Work Stealing Deque
+Chase-Lev deque with the C11 memory orders of Le, Pop, Cohen and Zappa
+Nardelli, "Correct and Efficient Work-Stealing for Weak Memory Models"
+
+The owner pushes and pops at the bottom without atomic read-modify-write
+except when taking the last element, thieves steal from the top with one
+CAS, top and bottom sit on separate cache lines so thieves polling top do
+not bounce the owner's bottom
+
+The circular array doubles when full, the old array may still be read by a
+thief that loaded it before the switch, so replaced arrays are kept on a
+list and handed back to the allocator by reclaim() once no steal can be in
+flight, or by the destructor, the memory held is at most twice the largest
+array
+
+T is stored in std::atomic<T>, it must be trivially copyable and lock-free,
+typically a task pointer
+*/
+
+#include <bsl/alloc.h>
+#include <config.h>
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace bsl {
+
+enum ws_steal : uint8_t {
+  WS_EMPTY = 0,
+  // lost a race against the owner or another thief, retry or move on
+  WS_ABORT = 1,
+  WS_SUCCESS = 2,
+};
+
+/**
+ * @brief Chase-Lev work stealing deque
+ * @tparam Alloc array allocator
+ * @tparam MinCap initial capacity, power of 2
+ */
+template <typename T, allocator Alloc = heap_alloc_t, size_t MinCap = 64>
+class ws_deque_t {
+  static_assert(std::is_trivially_copyable_v<T> &&
+                    std::atomic<T>::is_always_lock_free,
+                "deque elements are lock-free atomics");
+  static_assert(MinCap > 0 && (MinCap & (MinCap - 1)) == 0,
+                "capacity must be a power of 2");
+
+  struct array_t {
+    int64_t mask;
+    // previously replaced array, owner only
+    array_t *prev;
+
+    std::atomic<T> *slots() noexcept {
+      return reinterpret_cast<std::atomic<T> *>(this + 1);
+    }
+    [[nodiscard]] T get(int64_t idx) noexcept {
+      return slots()[idx & mask].load(std::memory_order_relaxed);
+    }
+    void put(int64_t idx, T val) noexcept {
+      slots()[idx & mask].store(val, std::memory_order_relaxed);
+    }
+  };
+
+  CL_ALIGN std::atomic<int64_t> top{0};
+  CL_ALIGN std::atomic<int64_t> bottom{0};
+  CL_ALIGN std::atomic<array_t *> array{nullptr};
+  array_t *retired = nullptr;
+  [[no_unique_address]] Alloc alloc{};
+
+  static size_t array_bytes(int64_t cap) noexcept {
+    return sizeof(array_t) + (size_t)cap * sizeof(std::atomic<T>);
+  }
+
+  array_t *new_array(int64_t cap) noexcept {
+    auto *mem = alloc.allocate(array_bytes(cap), alignof(array_t));
+    if (mem == nullptr) [[unlikely]] {
+      return nullptr;
+    }
+    auto *arr = new (mem) array_t{cap - 1, nullptr};
+    for (int64_t i = 0; i < cap; ++i) {
+      new (&arr->slots()[i]) std::atomic<T>();
+    }
+    return arr;
+  }
+
+  void free_array(array_t *arr) noexcept {
+    alloc.deallocate(arr, array_bytes(arr->mask + 1), alignof(array_t));
+  }
+
+  // owner only, copy [t, b) into a twice larger array
+  NOINLINE array_t *grow(array_t *arr, int64_t b, int64_t t) noexcept {
+    auto *ret = new_array(arr != nullptr ? (arr->mask + 1) * 2 : MinCap);
+    if (ret == nullptr) [[unlikely]] {
+      return nullptr;
+    }
+    if (arr != nullptr) {
+      for (auto i = t; i < b; ++i) {
+        ret->put(i, arr->get(i));
+      }
+      arr->prev = retired;
+      retired = arr;
+    }
+    array.store(ret, std::memory_order_release);
+    return ret;
+  }
+
+ public:
+  ws_deque_t() noexcept = default;
+  explicit ws_deque_t(Alloc alloc) noexcept : alloc(std::move(alloc)) {}
+  ws_deque_t(const ws_deque_t &) = delete;
+  ws_deque_t(ws_deque_t &&) = delete;
+  ws_deque_t &operator=(const ws_deque_t &) = delete;
+  ws_deque_t &operator=(ws_deque_t &&) = delete;
+  ~ws_deque_t() noexcept {
+    reclaim();
+    if (auto *arr = array.load(std::memory_order_relaxed); arr != nullptr) {
+      free_array(arr);
+    }
+  }
+
+  /**
+   * @brief push at the bottom, owner only
+   * @return false if the array could not grow
+   */
+  bool push(T val) noexcept {
+    auto b = bottom.load(std::memory_order_relaxed);
+    auto t = top.load(std::memory_order_acquire);
+    auto *arr = array.load(std::memory_order_relaxed);
+    if (arr == nullptr || b - t > arr->mask) [[unlikely]] {
+      arr = grow(arr, b, t);
+      if (arr == nullptr) {
+        return false;
+      }
+    }
+    arr->put(b, val);
+    // the element is visible before the thieves see the new bottom
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * @brief pop from the bottom, owner only
+   * @return false if empty, or a thief took the last element
+   */
+  bool pop(T &out) noexcept {
+    auto b = bottom.load(std::memory_order_relaxed) - 1;
+    auto *arr = array.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    // reserve the bottom element before reading top, pairs with the fence
+    // in steal
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    out = arr->get(b);
+    if (t != b) {
+      return true;
+    }
+    // last element, race the thieves for it
+    bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return won;
+  }
+
+  /**
+   * @brief steal from the top, any thread
+   * @return WS_SUCCESS with out set, WS_EMPTY, or WS_ABORT on a lost race
+   */
+  ws_steal steal(T &out) noexcept {
+    auto t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+      return WS_EMPTY;
+    }
+    // acquire pairs with the release store of a grown array
+    auto *arr = array.load(std::memory_order_acquire);
+    auto val = arr->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed)) {
+      return WS_ABORT;
+    }
+    out = val;
+    return WS_SUCCESS;
+  }
+
+  /**
+   * @brief free the arrays replaced by growth, owner only, no steal may be
+   * in flight (e.g. between fork/join phases)
+   */
+  void reclaim() noexcept {
+    while (retired != nullptr) {
+      auto *prev = retired->prev;
+      free_array(retired);
+      retired = prev;
+    }
+  }
+
+  // racy estimate, exact for the owner when no thief is active
+  [[nodiscard]] size_t size() const noexcept {
+    auto b = bottom.load(std::memory_order_relaxed);
+    auto t = top.load(std::memory_order_relaxed);
+    return b > t ? (size_t)(b - t) : 0;
+  }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+};
+
+}  // namespace bsl
@@ -0,0 +1,51 @@
+#include <bsl/cassert.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// function reported by the last failure
+static const char *failed_func = nullptr;
+
+extern "C" {
+
+// the failure below is expected, exit cleanly if it named the right function
+[[noreturn]] void _abort() noexcept {
+  bool named = failed_func != nullptr &&
+               std::strstr(failed_func, "must_be_positive") != nullptr &&
+               std::strstr(failed_func, "lambda") == nullptr;
+  std::_Exit(named ? 0 : 1);
+}
+
+void abort_msg(const char *msg, const char *file, unsigned line,
+               const char *func) noexcept {
+  std::fprintf(stderr, "%s:%u: %s: %s\n", file, line, func, msg);
+  failed_func = func;
+}
+}
+
+// assertions must stay usable in constant expressions
+constexpr int checked_div(int num, int den) {
+  assert(den != 0);
+  assert_full(num >= 0);
+  return num / den;
+}
+static_assert(checked_div(6, 3) == 2);
+
+constexpr int must_be_positive(int val) {
+  if (val <= 0) {
+    panic(val <= 0);
+  }
+  return val;
+}
+static_assert(must_be_positive(1) == 1);
+
+int main(int argc, char **) {
+  // runtime path, argc keeps the check out of constant folding
+  if (checked_div(argc * 4, argc) != 4) {
+    return 1;
+  }
+  // must fail and report must_be_positive, not the descriptor lambda
+  must_be_positive(argc - 1);
+  return 1;
+}
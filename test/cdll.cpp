@@ -1,5 +1,6 @@
 #include <bsl/cdll.h>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <iostream>
@@ -58,6 +59,53 @@ void check_contents(auto const &l, auto const &a) {
   }
 }
 
+void counted_test() {
+  static_assert(sizeof(bsl::cdll_t<int, true>) == 24U);
+  std::array<bsl::cdlln_t<unsigned>, 16> narr;
+  bsl::counted_cdll_t<unsigned> l1(bsl::in_place);
+  bsl::cdll_t<unsigned> l2(bsl::in_place);
+  for (unsigned i = 0; i < 16; ++i) {
+    narr[i].value() = (i * 7) % 5;
+    l1.push_back(narr[i]);
+  }
+  assert(l1.size() == 16);
+  l1.pop_front();
+  l1.erase(narr[5]);
+  assert(check_integrity(l1, 14));
+
+  // range splice between counted and uncounted lists
+  l2.splice(l2.end(), l1, l1.begin() + 2, l1.begin() + 6);
+  assert(check_integrity(l1, 10) && check_integrity(l2, 4));
+  std::array<unsigned, 4> l2_chk = {1, 3, 2, 4};
+  check_contents(l2, l2_chk);
+  l1.splice(l1.begin(), l2, l2.begin() + 1);
+  assert(check_integrity(l1, 11) && check_integrity(l2, 3));
+  assert(l1.front()->value() == 3);
+  l1.splice(l1.end(), l2);
+  assert(check_integrity(l1, 14) && l2.empty());
+
+  // stable sort, equal values keep their relative order
+  std::array<const bsl::cdlln_t<unsigned> *, 14> order;
+  auto order_itr = order.begin();
+  for (auto &node : l1) {
+    *order_itr++ = &node;
+  }
+  auto rank = [&](auto const *node) {
+    return std::find(order.begin(), order.end(), node) - order.begin();
+  };
+  l1.sort();
+  assert(check_integrity(l1, 14));
+  for (auto prev = l1.begin(), itr = prev + 1; itr != l1.end();
+       prev = itr++) {
+    assert(prev->value() < itr->value() ||
+           (prev->value() == itr->value() && rank(&*prev) < rank(&*itr)));
+  }
+  l1.sort([](auto const &lhs, auto const &rhs) {
+    return lhs.value() > rhs.value();
+  });
+  assert(l1.front()->value() == 4 && l1.back()->value() == 0);
+}
+
 int main() {
   static_assert(sizeof(bsl::cdll_t<int>) == 16U);
   static_assert(sizeof(bsl::cdlln_t<int>) == 24U);
@@ -91,4 +139,5 @@ int main() {
   auto l1_itr = l1.begin();
   auto l2_itr = l2.crbegin();
   l2_itr = l1_itr;
+  counted_test();
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include <bsl/small_vec.h>
+
+#include <cassert>
+#include <iterator>
+#include <string>
+
+// ranges are walked twice, once for the length and once to copy
+template <typename Vec, typename Itr>
+concept range_insertable = requires(Vec vec, Itr itr) {
+  vec.insert(vec.begin(), itr, itr);
+  vec.assign(itr, itr);
+};
+static_assert(range_insertable<bsl::small_vec<int, 2>, const int *>);
+static_assert(
+    !range_insertable<bsl::small_vec<int, 2>, std::istream_iterator<int>>);
+
+// heap allocator tagged with an id, records who frees what
+struct tagged_alloc_t {
+  int id = 0;
+  int *live = nullptr;
+
+  [[nodiscard]] void *allocate(size_t size, size_t align) noexcept {
+    auto *ptr = (char *)bsl::heap_alloc_t{}.allocate(size + 16, align);
+    *(int *)ptr = id;
+    live[id]++;
+    return ptr + 16;
+  }
+  void deallocate(void *ptr, size_t size, size_t align) noexcept {
+    auto *base = (char *)ptr - 16;
+    // a buffer must go back to the allocator it came from
+    assert(*(int *)base == id);
+    live[id]--;
+    bsl::heap_alloc_t{}.deallocate(base, size + 16, align);
+  }
+};
+
+int main() {
+  // arguments referring to the vector survive growth
+  bsl::small_vec<std::string, 2> strs;
+  strs.push_back(std::string(40, 'a'));
+  for (int i = 0; i < 20; ++i) {
+    strs.push_back(strs[0]);
+  }
+  strs.insert(strs.begin(), 5, strs[3]);
+  for (const auto &str : strs) {
+    assert(str == std::string(40, 'a'));
+  }
+
+  bsl::small_vec<int, 3> ints;
+  ints.push_back(1);
+  ints.push_back(2);
+  ints.push_back(3);
+  ints.insert(ints.begin(), ints[2]);
+  assert(ints.size() == 4 && ints[0] == 3 && ints[1] == 1 && ints[3] == 3);
+
+  // move assignment between distinct stateful allocators
+  int live[2] = {};
+  {
+    using vec_t = bsl::small_vec<int, 2, tagged_alloc_t>;
+    vec_t lhs(tagged_alloc_t{0, live});
+    vec_t rhs(tagged_alloc_t{1, live});
+    for (int i = 0; i < 8; ++i) {
+      lhs.push_back(i);
+      rhs.push_back(i * 10);
+    }
+    lhs = std::move(rhs);
+    assert(live[0] == 0 && live[1] == 1);
+    assert(lhs.size() == 8 && lhs[7] == 70 && rhs.empty() && rhs.is_inline());
+    // rhs grows through the allocator it was handed
+    for (int i = 0; i < 8; ++i) {
+      rhs.push_back(i);
+    }
+    assert(live[0] == 1);
+    vec_t moved(std::move(lhs));
+    assert(moved[7] == 70 && live[1] == 1);
+  }
+  assert(live[0] == 0 && live[1] == 0);
+  return 0;
+}
@@ -0,0 +1,125 @@
+// host decoder for bsl::trace_t memory dumps
+// scans the dump for the event table and the per-CPU rings on cache line
+// boundaries, merges the surviving records of every ring by timestamp and
+// prints one line per record, with a counter frequency the timestamps are
+// shown in ns relative to the first record
+
+#include <bsl/trace.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct entry_t {
+  bsl::trace_rec_t rec;
+  uint32_t cpu;
+};
+
+std::vector<char> read_file(const char *path) {
+  std::vector<char> ret;
+  auto *file = std::fopen(path, "rb");
+  if (file == nullptr) {
+    return ret;
+  }
+  char buf[1 << 16];
+  size_t len;
+  while ((len = std::fread(buf, 1, sizeof(buf), file)) > 0) {
+    ret.insert(ret.end(), buf, buf + len);
+  }
+  std::fclose(file);
+  return ret;
+}
+
+}  // namespace
+
+// usage: trace_decode dump [counter_hz]
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s dump [counter_hz]\n", argv[0]);
+    return 2;
+  }
+  auto hz = argc > 2 ? std::strtoull(argv[2], nullptr, 0) : 0;
+  auto dump = read_file(argv[1]);
+  // the dump buffer is copied to aligned memory so records can be read
+  // in place
+  std::vector<bsl::trace_rec_t> mem(dump.size() / sizeof(bsl::trace_rec_t));
+  std::copy(dump.begin(), dump.begin() + (long)(mem.size() * sizeof(mem[0])),
+            reinterpret_cast<char *>(mem.data()));
+  const auto *base = reinterpret_cast<const char *>(mem.data());
+  size_t len = mem.size() * sizeof(mem[0]);
+
+  const bsl::trace_desc_t *desc = nullptr;
+  uint32_t ndesc = 0;
+  std::vector<entry_t> entries;
+  size_t rings = 0;
+  uint64_t dropped = 0;
+  for (size_t off = 0; off + CACHELINE_SZ <= len;) {
+    auto magic = *reinterpret_cast<const uint64_t *>(base + off);
+    if (magic == bsl::TRACE_TABLE_MAGIC && desc == nullptr) {
+      const auto *hdr =
+          reinterpret_cast<const bsl::trace_table_hdr_t *>(base + off);
+      auto bytes = sizeof(*hdr) + hdr->count * sizeof(bsl::trace_desc_t);
+      if (bytes <= len - off) {
+        desc = reinterpret_cast<const bsl::trace_desc_t *>(hdr + 1);
+        ndesc = hdr->count;
+        off += bytes / CACHELINE_SZ * CACHELINE_SZ;
+        continue;
+      }
+    }
+    if (magic == bsl::TRACE_RING_MAGIC) {
+      auto view = bsl::trace_ring_view_t::make(base + off, len - off);
+      if (view.valid()) {
+        ++rings;
+        for (auto idx = view.first(); idx < view.last(); ++idx) {
+          bsl::trace_rec_t rec;
+          if (!view.at(idx, rec)) {
+            ++dropped;
+            continue;
+          }
+          entries.push_back({rec, view.cpu()});
+        }
+        off += view.bytes();
+        continue;
+      }
+    }
+    off += CACHELINE_SZ;
+  }
+  if (desc == nullptr) {
+    std::fprintf(stderr, "no event table in dump\n");
+    return 1;
+  }
+
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const entry_t &lhs, const entry_t &rhs) {
+                     return lhs.rec.stamp < rhs.rec.stamp;
+                   });
+  auto t0 = entries.empty() ? 0 : entries.front().rec.stamp;
+  for (const auto &ent : entries) {
+    const auto *rec = &ent.rec;
+    char line[256];
+    size_t line_len = 0;
+    const char *name = "?";
+    if (rec->event < ndesc) {
+      name = desc[rec->event].name;
+      line_len = bsl::trace_format(
+          line, sizeof(line),
+          bsl::sv_t(desc[rec->event].fmt,
+                    strnlen(desc[rec->event].fmt, bsl::TRACE_FMT_SZ)),
+          rec->args, rec->nargs);
+    }
+    if (hz != 0) {
+      std::printf("%14.0f", (double)(rec->stamp - t0) * 1e9 / (double)hz);
+    } else {
+      std::printf("%20lu", (unsigned long)rec->stamp);
+    }
+    std::printf(" cpu%-3u %-24.*s %.*s\n", ent.cpu,
+                (int)bsl::TRACE_NAME_SZ, name, (int)line_len, line);
+  }
+  std::fprintf(stderr, "%zu rings, %zu records, %lu torn\n", rings,
+               entries.size(), (unsigned long)dropped);
+  return 0;
+}